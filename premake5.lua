@@ -32,6 +32,11 @@ CreateWorkspace({name = "crypt"})
 			SOURCE_DIRECTORY .. "/module/*.cpp"
 		})
 
+		filter("system:linux")
+			links("pthread")
+
+		filter({})
+
 	CreateProject({serverside = false, manual_files = true})
 		IncludeLuaShared()
 		defines("CRYPTOPP_ENABLE_NAMESPACE_WEAK=1")
@@ -48,6 +53,11 @@ CreateWorkspace({name = "crypt"})
 			SOURCE_DIRECTORY .. "/module/*.cpp"
 		})
 
+		filter("system:linux")
+			links("pthread")
+
+		filter({})
+
 	project("cryptopp")
 		kind("StaticLib")
 		vectorextensions("AVX2")
@@ -74,6 +84,7 @@ CreateWorkspace({name = "crypt"})
 
 	project("testing")
 		kind("ConsoleApp")
+		defines("CRYPTOPP_ENABLE_NAMESPACE_WEAK=1")
 		links("cryptopp")
 		includedirs({
 			CRYPTOPP_DIRECTORY .. "/include",
@@ -88,3 +99,6 @@ CreateWorkspace({name = "crypt"})
 			["Header files/*"] = SOURCE_DIRECTORY .. "/*.hpp",
 			["Source files/*"] = SOURCE_DIRECTORY .. "/*.cpp"
 		})
+
+		filter("system:linux")
+			links("pthread")
@@ -0,0 +1,88 @@
+#include <batchdigest.hpp>
+#include <threadpool.hpp>
+
+namespace cryptography
+{
+	namespace
+	{
+		// below this much input the pool round trip costs more than hashing on one core
+		static const size_t ParallelThreshold = 64 * 1024;
+
+		// Runs function( hash, begin, end ) over the messages, on clones when going parallel.
+		template<typename Function>
+		void ForEachRange(
+			CryptoPP::HashTransformation &hash,
+			const std::vector<bytes> &messages,
+			bool parallel,
+			Function function
+		)
+		{
+			hash.Restart( );
+
+			size_t total = 0;
+			for( const bytes &message : messages )
+				total += message.size( );
+
+			if( parallel && total >= ParallelThreshold && messages.size( ) > 1 )
+			{
+				std::unique_ptr<CryptoPP::HashTransformation> probe;
+				try
+				{
+					probe.reset( static_cast<CryptoPP::HashTransformation *>( hash.Clone( ) ) );
+				}
+				catch( const CryptoPP::NotImplemented & )
+				{ }
+
+				if( probe )
+				{
+					ThreadPool::Instance( ).ParallelFor( messages.size( ), [&hash, &function]( size_t begin, size_t end )
+					{
+						std::unique_ptr<CryptoPP::HashTransformation> clone(
+							static_cast<CryptoPP::HashTransformation *>( hash.Clone( ) )
+						);
+						function( *clone, begin, end );
+					} );
+					return;
+				}
+			}
+
+			function( hash, 0, messages.size( ) );
+		}
+	}
+
+	void DigestMany(
+		CryptoPP::HashTransformation &hash,
+		const std::vector<bytes> &messages,
+		std::vector<bytes> &digests,
+		bool parallel
+	)
+	{
+		std::vector<bytes> results( messages.size( ), bytes( hash.DigestSize( ) ) );
+		ForEachRange( hash, messages, parallel, [&messages, &results]( CryptoPP::HashTransformation &h, size_t begin, size_t end )
+		{
+			for( size_t i = begin; i < end; ++i )
+				h.CalculateDigest( results[i].data( ), messages[i].data( ), messages[i].size( ) );
+		} );
+
+		digests.swap( results );
+	}
+
+	void VerifyMany(
+		CryptoPP::HashTransformation &hash,
+		const std::vector<bytes> &messages,
+		const std::vector<bytes> &tags,
+		std::vector<uint8_t> &valid,
+		bool parallel
+	)
+	{
+		std::vector<uint8_t> results( messages.size( ), 0 );
+		ForEachRange( hash, messages, parallel, [&messages, &tags, &results]( CryptoPP::HashTransformation &h, size_t begin, size_t end )
+		{
+			for( size_t i = begin; i < end; ++i )
+				if( tags[i].size( ) == h.DigestSize( ) )
+					results[i] = h.VerifyDigest( tags[i].data( ), messages[i].data( ), messages[i].size( ) ) ? 1 : 0;
+		} );
+
+		valid.swap( results );
+	}
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cryptography.hpp>
+
+namespace cryptography
+{
+	// Digests every message independently with one keyed or initialized hash, restarting it in
+	// between. With parallel set and enough input to pay for it, contiguous ranges of messages
+	// run on the thread pool, each on its own Clone of hash. Hashes that can't be cloned always
+	// run on the calling thread.
+	void DigestMany(
+		CryptoPP::HashTransformation &hash,
+		const std::vector<bytes> &messages,
+		std::vector<bytes> &digests,
+		bool parallel
+	);
+
+	// valid[i] is 1 when tags[i] is exactly the digest of messages[i], compared in constant time.
+	// tags must hold one entry per message.
+	void VerifyMany(
+		CryptoPP::HashTransformation &hash,
+		const std::vector<bytes> &messages,
+		const std::vector<bytes> &tags,
+		std::vector<uint8_t> &valid,
+		bool parallel
+	);
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cryptopp/cryptlib.h>
+
+namespace cryptography
+{
+	// Gives the Crypto++ hashes that don't implement Clone (CRC32C, SHA-3, SHAKE, BLAKE2) one
+	// that copies their whole state, so a common prefix can be absorbed once and forked.
+	template<typename Hash>
+	class ClonableHash : public Hash
+	{
+	public:
+		ClonableHash( ) { }
+
+		ClonableHash *Clone( ) const
+		{
+			return new ClonableHash( *this );
+		}
+	};
+}
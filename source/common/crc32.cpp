@@ -0,0 +1,321 @@
+#include <crc32.hpp>
+
+#include <cryptopp/cpu.h>
+#include <cryptopp/misc.h>
+#include <cstring>
+
+#if defined __x86_64__ || defined __i386__ || defined _M_X64 || defined _M_IX86
+
+#define CRYPTOGRAPHY_CRC32_X86
+
+#include <emmintrin.h>
+#include <smmintrin.h>
+#include <nmmintrin.h>
+#include <wmmintrin.h>
+
+#if defined __GNUC__ || defined __clang__
+
+#define CRYPTOGRAPHY_CRC32_TARGET __attribute__( ( target( "pclmul,sse4.1" ) ) )
+#define CRYPTOGRAPHY_CRC32C_TARGET __attribute__( ( target( "sse4.2" ) ) )
+
+#else
+
+#define CRYPTOGRAPHY_CRC32_TARGET
+#define CRYPTOGRAPHY_CRC32C_TARGET
+
+#endif
+
+#endif
+
+namespace cryptography
+{
+	namespace
+	{
+		// bytes the vector code doesn't take go through a plain reflected table
+		template<CryptoPP::word32 Polynomial>
+		struct Table
+		{
+			Table( )
+			{
+				for( CryptoPP::word32 i = 0; i < 256; ++i )
+				{
+					CryptoPP::word32 value = i;
+					for( int k = 0; k < 8; ++k )
+						value = ( value >> 1 ) ^ ( Polynomial & ( 0 - ( value & 1 ) ) );
+
+					entries[i] = value;
+				}
+			}
+
+			CryptoPP::word32 entries[256];
+		};
+
+		template<CryptoPP::word32 Polynomial>
+		CryptoPP::word32 UpdateTable( CryptoPP::word32 crc, const CryptoPP::byte *input, size_t length )
+		{
+			static const Table<Polynomial> table;
+			for( size_t i = 0; i < length; ++i )
+				crc = table.entries[( crc ^ input[i] ) & 0xFF] ^ ( crc >> 8 );
+
+			return crc;
+		}
+
+		static const CryptoPP::word32 IEEE = 0xEDB88320;
+		static const CryptoPP::word32 Castagnoli = 0x82F63B78;
+
+		void Output( CryptoPP::word32 crc, CryptoPP::byte *digest, size_t size )
+		{
+			CryptoPP::byte value[4];
+			CryptoPP::PutWord( false, CryptoPP::LITTLE_ENDIAN_ORDER, value, crc ^ 0xFFFFFFFF );
+			std::copy( value, value + size, digest );
+		}
+
+		// the register after the header, big endian
+		void ExportRegister( const std::string &name, CryptoPP::word32 crc, bytes &state )
+		{
+			bytes result;
+			WriteHashStateHeader( name, result );
+			result.resize( result.size( ) + 4 );
+			CryptoPP::PutWord( false, CryptoPP::BIG_ENDIAN_ORDER, &result[result.size( ) - 4], crc );
+			state.swap( result );
+		}
+
+		CryptoPP::word32 ImportRegister( const std::string &name, const bytes &state )
+		{
+			const size_t offset = ReadHashStateHeader( name, state );
+			if( state.size( ) != offset + 4 )
+				throw CryptoPP::InvalidDataFormat( name + ": hash state has the wrong size" );
+
+			return CryptoPP::GetWord<CryptoPP::word32>( false, CryptoPP::BIG_ENDIAN_ORDER, &state[offset] );
+		}
+
+#if defined CRYPTOGRAPHY_CRC32_X86
+
+		// Folds length bytes, a multiple of 16 and at least 64, into crc. The constants are the
+		// bit-reflected x^(k) mod P values from the paper, the last pair is P and the Barrett mu.
+		CRYPTOGRAPHY_CRC32_TARGET
+		CryptoPP::word32 Fold( CryptoPP::word32 crc, const CryptoPP::byte *input, size_t length )
+		{
+			const __m128i k1k2 = _mm_set_epi64x( 0x01c6e41596, 0x0154442bd4 );
+			const __m128i k3k4 = _mm_set_epi64x( 0x00ccaa009e, 0x01751997d0 );
+			const __m128i k5k0 = _mm_set_epi64x( 0, 0x0163cd6124 );
+			const __m128i poly = _mm_set_epi64x( 0x01f7011641, 0x01db710641 );
+			const __m128i low32 = _mm_setr_epi32( ~0, 0, ~0, 0 );
+
+			__m128i x1 = _mm_loadu_si128( reinterpret_cast<const __m128i *>( input ) );
+			__m128i x2 = _mm_loadu_si128( reinterpret_cast<const __m128i *>( input + 16 ) );
+			__m128i x3 = _mm_loadu_si128( reinterpret_cast<const __m128i *>( input + 32 ) );
+			__m128i x4 = _mm_loadu_si128( reinterpret_cast<const __m128i *>( input + 48 ) );
+			x1 = _mm_xor_si128( x1, _mm_cvtsi32_si128( static_cast<int>( crc ) ) );
+			input += 64;
+			length -= 64;
+
+			// four independent lanes, each folded 512 bits forward
+			while( length >= 64 )
+			{
+				const __m128i x5 = _mm_clmulepi64_si128( x1, k1k2, 0x00 );
+				const __m128i x6 = _mm_clmulepi64_si128( x2, k1k2, 0x00 );
+				const __m128i x7 = _mm_clmulepi64_si128( x3, k1k2, 0x00 );
+				const __m128i x8 = _mm_clmulepi64_si128( x4, k1k2, 0x00 );
+
+				x1 = _mm_clmulepi64_si128( x1, k1k2, 0x11 );
+				x2 = _mm_clmulepi64_si128( x2, k1k2, 0x11 );
+				x3 = _mm_clmulepi64_si128( x3, k1k2, 0x11 );
+				x4 = _mm_clmulepi64_si128( x4, k1k2, 0x11 );
+
+				x1 = _mm_xor_si128( _mm_xor_si128( x1, x5 ), _mm_loadu_si128( reinterpret_cast<const __m128i *>( input ) ) );
+				x2 = _mm_xor_si128( _mm_xor_si128( x2, x6 ), _mm_loadu_si128( reinterpret_cast<const __m128i *>( input + 16 ) ) );
+				x3 = _mm_xor_si128( _mm_xor_si128( x3, x7 ), _mm_loadu_si128( reinterpret_cast<const __m128i *>( input + 32 ) ) );
+				x4 = _mm_xor_si128( _mm_xor_si128( x4, x8 ), _mm_loadu_si128( reinterpret_cast<const __m128i *>( input + 48 ) ) );
+
+				input += 64;
+				length -= 64;
+			}
+
+			// fold the lanes into one, then the remaining 16-byte blocks, 128 bits forward each
+			const __m128i lanes[3] = { x2, x3, x4 };
+			for( const __m128i &lane : lanes )
+			{
+				const __m128i x5 = _mm_clmulepi64_si128( x1, k3k4, 0x00 );
+				x1 = _mm_clmulepi64_si128( x1, k3k4, 0x11 );
+				x1 = _mm_xor_si128( _mm_xor_si128( x1, lane ), x5 );
+			}
+
+			for( ; length >= 16; input += 16, length -= 16 )
+			{
+				const __m128i x5 = _mm_clmulepi64_si128( x1, k3k4, 0x00 );
+				x1 = _mm_clmulepi64_si128( x1, k3k4, 0x11 );
+				x1 = _mm_xor_si128( _mm_xor_si128( x1, _mm_loadu_si128( reinterpret_cast<const __m128i *>( input ) ) ), x5 );
+			}
+
+			// 128 to 64 bits
+			x2 = _mm_clmulepi64_si128( x1, k3k4, 0x10 );
+			x1 = _mm_xor_si128( _mm_srli_si128( x1, 8 ), x2 );
+
+			x2 = _mm_srli_si128( x1, 4 );
+			x1 = _mm_clmulepi64_si128( _mm_and_si128( x1, low32 ), k5k0, 0x00 );
+			x1 = _mm_xor_si128( x1, x2 );
+
+			// Barrett reduction to 32 bits
+			x2 = _mm_clmulepi64_si128( _mm_and_si128( x1, low32 ), poly, 0x10 );
+			x2 = _mm_clmulepi64_si128( _mm_and_si128( x2, low32 ), poly, 0x00 );
+			x1 = _mm_xor_si128( x1, x2 );
+
+			return static_cast<CryptoPP::word32>( _mm_extract_epi32( x1, 1 ) );
+		}
+
+		CRYPTOGRAPHY_CRC32C_TARGET
+		CryptoPP::word32 UpdateSSE42( CryptoPP::word32 crc, const CryptoPP::byte *input, size_t length )
+		{
+
+#if defined __x86_64__ || defined _M_X64
+
+			CryptoPP::word64 wide = crc;
+			for( ; length >= 8; input += 8, length -= 8 )
+			{
+				CryptoPP::word64 word;
+				std::memcpy( &word, input, sizeof( word ) );
+				wide = _mm_crc32_u64( wide, word );
+			}
+
+			crc = static_cast<CryptoPP::word32>( wide );
+
+#endif
+
+			for( ; length >= 4; input += 4, length -= 4 )
+			{
+				CryptoPP::word32 word;
+				std::memcpy( &word, input, sizeof( word ) );
+				crc = _mm_crc32_u32( crc, word );
+			}
+
+			for( ; length != 0; ++input, --length )
+				crc = _mm_crc32_u8( crc, *input );
+
+			return crc;
+		}
+
+#endif
+
+	}
+
+	CRC32::CRC32( ) :
+		fast( HasFastKernel( ) ),
+		crc( 0xFFFFFFFF )
+	{ }
+
+	void CRC32::Update( const CryptoPP::byte *input, size_t length )
+	{
+
+#if defined CRYPTOGRAPHY_CRC32_X86
+
+		if( fast && length >= 64 )
+		{
+			const size_t blocks = length & ~size_t( 15 );
+			crc = Fold( crc, input, blocks );
+			input += blocks;
+			length -= blocks;
+		}
+
+#endif
+
+		crc = UpdateTable<IEEE>( crc, input, length );
+	}
+
+	void CRC32::TruncatedFinal( CryptoPP::byte *digest, size_t size )
+	{
+		ThrowIfInvalidTruncatedSize( size );
+		Output( crc, digest, size );
+		Restart( );
+	}
+
+	void CRC32::Restart( )
+	{
+		crc = 0xFFFFFFFF;
+	}
+
+	void CRC32::ExportState( bytes &state ) const
+	{
+		ExportRegister( AlgorithmName( ), crc, state );
+	}
+
+	void CRC32::ImportState( const bytes &state )
+	{
+		crc = ImportRegister( AlgorithmName( ), state );
+	}
+
+	bool CRC32::HasFastKernel( )
+	{
+
+#if defined CRYPTOGRAPHY_CRC32_X86
+
+		static const bool pclmul = CryptoPP::HasCLMUL( ) && CryptoPP::HasSSE41( );
+		return pclmul;
+
+#else
+
+		return false;
+
+#endif
+
+	}
+
+	CRC32C::CRC32C( ) :
+		fast( HasFastKernel( ) ),
+		crc( 0xFFFFFFFF )
+	{ }
+
+	void CRC32C::Update( const CryptoPP::byte *input, size_t length )
+	{
+
+#if defined CRYPTOGRAPHY_CRC32_X86
+
+		if( fast )
+		{
+			crc = UpdateSSE42( crc, input, length );
+			return;
+		}
+
+#endif
+
+		crc = UpdateTable<Castagnoli>( crc, input, length );
+	}
+
+	void CRC32C::TruncatedFinal( CryptoPP::byte *digest, size_t size )
+	{
+		ThrowIfInvalidTruncatedSize( size );
+		Output( crc, digest, size );
+		Restart( );
+	}
+
+	void CRC32C::Restart( )
+	{
+		crc = 0xFFFFFFFF;
+	}
+
+	void CRC32C::ExportState( bytes &state ) const
+	{
+		ExportRegister( AlgorithmName( ), crc, state );
+	}
+
+	void CRC32C::ImportState( const bytes &state )
+	{
+		crc = ImportRegister( AlgorithmName( ), state );
+	}
+
+	bool CRC32C::HasFastKernel( )
+	{
+
+#if defined CRYPTOGRAPHY_CRC32_X86
+
+		static const bool sse42 = CryptoPP::HasSSE42( );
+		return sse42;
+
+#else
+
+		return false;
+
+#endif
+
+	}
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <hashstate.hpp>
+
+namespace cryptography
+{
+	// IEEE CRC32 with the same output as CryptoPP::CRC32, folding 64 bytes per iteration with
+	// carry-less multiplication (Gopal et al., "Fast CRC Computation for Generic Polynomials
+	// Using PCLMULQDQ Instruction") when the processor has PCLMULQDQ and SSE4.1. Otherwise a
+	// byte table is used.
+	class CRC32 : public CryptoPP::HashTransformation, public ResumableHash
+	{
+	public:
+		CRYPTOPP_CONSTANT( DIGESTSIZE = 4 );
+
+		static const char *StaticAlgorithmName( )
+		{
+			return "CRC32";
+		}
+
+		CRC32( );
+
+		std::string AlgorithmName( ) const
+		{
+			return StaticAlgorithmName( );
+		}
+
+		unsigned int DigestSize( ) const
+		{
+			return DIGESTSIZE;
+		}
+
+		unsigned int OptimalBlockSize( ) const
+		{
+			return 64;
+		}
+
+		void Update( const CryptoPP::byte *input, size_t length );
+
+		void TruncatedFinal( CryptoPP::byte *digest, size_t size );
+
+		void Restart( );
+
+		CRC32 *Clone( ) const
+		{
+			return new CRC32( *this );
+		}
+
+		void ExportState( bytes &state ) const;
+
+		void ImportState( const bytes &state );
+
+		// Whether this processor and build can use the folding implementation.
+		static bool HasFastKernel( );
+
+	private:
+		bool fast;
+		CryptoPP::word32 crc;
+	};
+
+	// Castagnoli CRC32C with the same output as CryptoPP::CRC32C, using the SSE4.2 crc32
+	// instruction when the processor has it and a byte table otherwise.
+	class CRC32C : public CryptoPP::HashTransformation, public ResumableHash
+	{
+	public:
+		CRYPTOPP_CONSTANT( DIGESTSIZE = 4 );
+
+		static const char *StaticAlgorithmName( )
+		{
+			return "CRC32C";
+		}
+
+		CRC32C( );
+
+		std::string AlgorithmName( ) const
+		{
+			return StaticAlgorithmName( );
+		}
+
+		unsigned int DigestSize( ) const
+		{
+			return DIGESTSIZE;
+		}
+
+		unsigned int OptimalBlockSize( ) const
+		{
+			return 8;
+		}
+
+		void Update( const CryptoPP::byte *input, size_t length );
+
+		void TruncatedFinal( CryptoPP::byte *digest, size_t size );
+
+		void Restart( );
+
+		CRC32C *Clone( ) const
+		{
+			return new CRC32C( *this );
+		}
+
+		void ExportState( bytes &state ) const;
+
+		void ImportState( const bytes &state );
+
+		// Whether this processor and build can use the crc32 instruction.
+		static bool HasFastKernel( );
+
+	private:
+		bool fast;
+		CryptoPP::word32 crc;
+	};
+}
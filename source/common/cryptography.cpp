@@ -1,11 +1,154 @@
 #include <cryptography.hpp>
 
 #include <cryptopp/oids.h>
+#include <cryptopp/modarith.h>
+#include <cryptopp/nbtheory.h>
 
 #include <unordered_map>
+#include <algorithm>
+#include <atomic>
 
 namespace cryptography
 {
+	namespace
+	{
+		// the acceptance rule of Crypto++'s internal RSAPrimeSelector, p - 1 must be coprime to e
+		class RSAPrimeSelector : public CryptoPP::PrimeSelector
+		{
+		public:
+			explicit RSAPrimeSelector( const CryptoPP::Integer &exponent ) :
+				e( exponent )
+			{ }
+
+			bool IsAcceptable( const CryptoPP::Integer &candidate ) const
+			{
+				return CryptoPP::RelativelyPrime( e, candidate - CryptoPP::Integer::One( ) );
+			}
+
+		private:
+			CryptoPP::Integer e;
+		};
+
+		// Every thread draws random starting points and sieves one search interval from each, like
+		// Integer::GenerateRandom does, until two distinct primes of half the modulus size are found.
+		void GeneratePrimes( unsigned int modulusSize, const CryptoPP::Integer &e, CryptoPP::Integer &p, CryptoPP::Integer &q )
+		{
+			if( modulusSize < 16 )
+				throw CryptoPP::InvalidArgument( "RSA: specified modulus size is too small" );
+
+			// the bounds of MakeParametersForTwoPrimesOfEqualSize, p * q has exactly modulusSize bits
+			CryptoPP::Integer min, max;
+			if( modulusSize % 2 == 0 )
+			{
+				min = CryptoPP::Integer( 182 ) << ( modulusSize / 2 - 8 );
+				max = CryptoPP::Integer::Power2( modulusSize / 2 ) - 1;
+			}
+			else
+			{
+				min = CryptoPP::Integer::Power2( ( modulusSize - 1 ) / 2 );
+				max = CryptoPP::Integer( 181 ) << ( ( modulusSize + 1 ) / 2 - 8 );
+			}
+
+			const RSAPrimeSelector selector( e );
+			const CryptoPP::Integer interval( static_cast<long>( CryptoPP::PrimeSearchInterval( max ) ) );
+
+			std::mutex mutex;
+			std::vector<CryptoPP::Integer> primes;
+			std::atomic<bool> done( false ), exhausted( false );
+			std::atomic<unsigned int> misses( 0 );
+
+			// Like the i == 16 check of Integer::GenerateRandom, after 16 draws that found nothing
+			// new make sure the range holds two acceptable primes at all, tiny moduli may not.
+			auto enough = [&]( )
+			{
+				CryptoPP::Integer first = min;
+				if( !CryptoPP::FirstPrime( first, max, CryptoPP::Integer::Zero( ), CryptoPP::Integer::One( ), &selector ) )
+					return false;
+
+				CryptoPP::Integer second = first + 1;
+				return CryptoPP::FirstPrime( second, max, CryptoPP::Integer::Zero( ), CryptoPP::Integer::One( ), &selector );
+			};
+
+			ThreadPool &pool = ThreadPool::Instance( );
+			pool.ParallelFor( pool.Size( ) + 1, [&]( size_t, size_t )
+			{
+				CryptoPP::AutoSeededRandomPool prng;
+				CryptoPP::Integer candidate;
+				while( !done )
+				{
+					candidate.Randomize( prng, min, max );
+					bool found = CryptoPP::FirstPrime(
+						candidate,
+						std::min( candidate + interval, max ),
+						CryptoPP::Integer::Zero( ),
+						CryptoPP::Integer::One( ),
+						&selector
+					);
+					if( found )
+					{
+						std::lock_guard<std::mutex> lock( mutex );
+						found = !done && ( primes.empty( ) || primes[0] != candidate );
+						if( found )
+						{
+							primes.push_back( candidate );
+							done = primes.size( ) == 2;
+						}
+					}
+
+					if( !found && ++misses == 16 && !enough( ) )
+					{
+						exhausted = true;
+						done = true;
+					}
+				}
+			} );
+
+			if( exhausted )
+				throw CryptoPP::InvalidArgument( "RSA: no two acceptable primes of half the modulus size exist" );
+
+			p = primes[0];
+			q = primes[1];
+		}
+	}
+
+	bool Crypter::Precompute( )
+	{
+		SetLastError( AlgorithmName( ) + " does not support precomputation" );
+		return false;
+	}
+
+	bool Crypter::SetPrecomputationThreshold( size_t )
+	{
+		SetLastError( AlgorithmName( ) + " does not support precomputation" );
+		return false;
+	}
+
+	bool Crypter::SetEphemeralPoolSize( size_t )
+	{
+		SetLastError( AlgorithmName( ) + " does not use ephemeral keys" );
+		return false;
+	}
+
+	void Crypter::DecryptMany( const std::vector<bytes> &data, std::vector<bytes> &decrypted, std::vector<std::string> &errors )
+	{
+		decrypted.assign( data.size( ), bytes( ) );
+		errors.assign( data.size( ), std::string( ) );
+		for( size_t i = 0; i < data.size( ); ++i )
+			if( !Decrypt( data[i], decrypted[i] ) )
+				errors[i] = GetLastError( );
+	}
+
+	bool Crypter::SetLatencyMode( bool )
+	{
+		SetLastError( AlgorithmName( ) + " does not support latency mode" );
+		return false;
+	}
+
+	bool Crypter::IsPublicKey( ) const
+	{
+		return false;
+	}
+
 	AES::AES( ) :
 		ivset( false ),
 		keyset( false )
@@ -243,10 +386,20 @@ namespace cryptography
 	{
 		try
 		{
-			CryptoPP::RSA::PrivateKey privKey;
+			// mirrors InvertibleRSAFunction::GenerateRandom with the prime search spread over the pool
+			const CryptoPP::Integer e( 17 );
+			CryptoPP::Integer p, q, u;
+			do
+			{
+				GeneratePrimes( static_cast<unsigned int>( priSize ), e, p, q );
+				u = q.InverseMod( p );
+			}
+			while( u.IsZero( ) );
+
+			const CryptoPP::Integer d = e.InverseMod( CryptoPP::LCM( p - 1, q - 1 ) );
 
-			CryptoPP::AutoSeededRandomPool prng;
-			privKey.GenerateRandomWithKeySize( prng, priSize );
+			CryptoPP::RSA::PrivateKey privKey;
+			privKey.Initialize( p * q, e, d, p, q, d % ( p - 1 ), d % ( q - 1 ), u );
 
 			bytes_string priStr;
 			bytes_sink privSink( priStr );
@@ -337,14 +490,7 @@ namespace cryptography
 		{
 			CheckPrivateKey( );
 			CryptoPP::AutoSeededRandomPool prng;
-			decrypted.resize( decrypter.MaxPlaintextLength( encrypted.size( ) ) );
-			CryptoPP::DecodingResult res = decrypter.Decrypt(
-				prng,
-				encrypted.data( ),
-				encrypted.size( ),
-				decrypted.data( )
-			);
-			decrypted.resize( res.messageLength );
+			DecryptWith( prng, encrypted, decrypted );
 			return true;
 		}
 		catch( const CryptoPP::Exception &e )
@@ -354,6 +500,28 @@ namespace cryptography
 		}
 	}
 
+	void RSA::DecryptMany( const std::vector<bytes> &encrypted, std::vector<bytes> &decrypted, std::vector<std::string> &errors )
+	{
+		decrypted.assign( encrypted.size( ), bytes( ) );
+		errors.assign( encrypted.size( ), std::string( ) );
+
+		// the decryptor is only read, every range just needs its own generator
+		ThreadPool::Instance( ).ParallelFor( encrypted.size( ), [&]( size_t begin, size_t end )
+		{
+			CryptoPP::AutoSeededRandomPool prng;
+			for( size_t i = begin; i < end; ++i )
+				try
+				{
+					CheckPrivateKey( );
+					DecryptWith( prng, encrypted[i], decrypted[i] );
+				}
+				catch( const CryptoPP::Exception &e )
+				{
+					errors[i] = e.GetWhat( );
+				}
+		} );
+	}
+
 	bool RSA::Encrypt( const bytes &decrypted, bytes &encrypted )
 	{
 		try
@@ -371,6 +539,135 @@ namespace cryptography
 		}
 	}
 
+	bool RSA::IsPublicKey( ) const
+	{
+		return true;
+	}
+
+	RSA::PrivateKey::PrivateKey( ) :
+		latency( false )
+	{ }
+
+	void RSA::PrivateKey::SetLatencyMode( bool enabled )
+	{
+		latency = enabled;
+	}
+
+	void RSA::PrivateKey::Precompute( unsigned int )
+	{
+		modp = Context( );
+		modq = Context( );
+		if( Montgomery::IsFaster( m_p ) )
+			modp.fast = std::make_shared<const Montgomery>( m_p );
+		else
+			modp.generic = std::make_shared<const CryptoPP::MontgomeryRepresentation>( m_p );
+
+		if( Montgomery::IsFaster( m_q ) )
+			modq.fast = std::make_shared<const Montgomery>( m_q );
+		else
+			modq.generic = std::make_shared<const CryptoPP::MontgomeryRepresentation>( m_q );
+	}
+
+	// x ^ exponent mod modulus for one CRT half, the cached context is only trusted while it matches
+	CryptoPP::Integer RSA::PrivateKey::ExponentiateHalf(
+		const Context &context,
+		const CryptoPP::Integer &x,
+		const CryptoPP::Integer &exponent,
+		const CryptoPP::Integer &modulus
+	)
+	{
+		// only take over at the sizes where the MULX/ADX kernel measured faster than Integer
+		if( Montgomery::IsFaster( modulus ) )
+		{
+			if( context.fast && context.fast->GetModulus( ) == modulus )
+				return context.fast->Exponentiate( x, exponent );
+
+			return Montgomery( modulus ).Exponentiate( x, exponent );
+		}
+
+		if( !context.generic || context.generic->GetModulus( ) != modulus )
+			return a_exp_b_mod_c( x % modulus, exponent, modulus );
+
+		// MontgomeryRepresentation keeps mutable scratch space, concurrent callers work on copies
+		CryptoPP::MontgomeryRepresentation representation( *context.generic );
+		return representation.ConvertOut( representation.Exponentiate( representation.ConvertIn( x % modulus ), exponent ) );
+	}
+
+	CryptoPP::Integer RSA::PrivateKey::CalculateInverse( CryptoPP::RandomNumberGenerator &rng, const CryptoPP::Integer &x ) const
+	{
+		DoQuickSanityCheck( );
+		CryptoPP::ModularArithmetic modn( m_n );
+		CryptoPP::Integer r, rInv;
+		do
+		{
+			r.Randomize( rng, CryptoPP::Integer::One( ), m_n - CryptoPP::Integer::One( ) );
+			rInv = modn.MultiplicativeInverse( r );
+		}
+		while( rInv.IsZero( ) );
+
+		CryptoPP::Integer re = modn.Multiply( modn.Exponentiate( r, m_e ), x ); // blind
+
+		// Garner recombination, u = q^-1 mod p as in PKCS #1
+		CryptoPP::Integer mp, mq;
+		if( latency && !ThreadPool::IsWorkerThread( ) )
+		{
+			std::future<CryptoPP::Integer> half = ThreadPool::Instance( ).Submit( [this, &re]( )
+			{
+				return ExponentiateHalf( modq, re, m_dq, m_q );
+			} );
+
+			try
+			{
+				mp = ExponentiateHalf( modp, re, m_dp, m_p );
+			}
+			catch( ... )
+			{
+				half.wait( );
+				throw;
+			}
+
+			mq = half.get( );
+		}
+		else
+		{
+			mp = ExponentiateHalf( modp, re, m_dp, m_p );
+			mq = ExponentiateHalf( modq, re, m_dq, m_q );
+		}
+
+		CryptoPP::ModularArithmetic modm( m_p );
+		CryptoPP::Integer y = mq + m_q * modm.Multiply( m_u, modm.Subtract( mp, mq % m_p ) );
+
+		y = modn.Multiply( y, rInv ); // unblind
+		if( modn.Exponentiate( y, m_e ) != x )
+			throw CryptoPP::Exception(
+				CryptoPP::Exception::OTHER_ERROR,
+				"RSA: computational error during private key operation"
+			);
+
+		return y;
+	}
+
+	bool RSA::SetLatencyMode( bool enabled )
+	{
+		decrypter.AccessKey( ).SetLatencyMode( enabled );
+		return true;
+	}
+
+	void RSA::DecryptWith( CryptoPP::RandomNumberGenerator &prng, const bytes &encrypted, bytes &decrypted ) const
+	{
+		decrypted.resize( decrypter.MaxPlaintextLength( encrypted.size( ) ) );
+		CryptoPP::DecodingResult res = decrypter.Decrypt(
+			prng,
+			encrypted.data( ),
+			encrypted.size( ),
+			decrypted.data( )
+		);
+		if( !res.isValidCoding )
+			throw CryptoPP::InvalidCiphertext( "RSA: ciphertext failed to decode" );
+
+		decrypted.resize( res.messageLength );
+	}
+
 	void RSA::CheckPrivateKey( ) const
 	{
 		if( !prikeyset )
@@ -383,6 +680,7 @@ namespace cryptography
 	void RSA::SetPrivateKey( const CryptoPP::RSA::PrivateKey &privKey )
 	{
 		decrypter.AccessKey( ).AssignFrom( privKey );
+		decrypter.AccessKey( ).Precompute( );
 		prikeyset = true;
 	}
 
@@ -403,9 +701,21 @@ namespace cryptography
 
 	ECP::ECP( ) :
 		prikeyset( false ),
-		pubkeyset( false )
+		pubkeyset( false ),
+		prikeyp256( false ),
+		pubkeyp256( false ),
+		precomputed( false ),
+		precomputeThreshold( 0 ),
+		encryptions( 0 ),
+		ephemeralPoolSize( 0 )
 	{ }
 
+	ECP::~ECP( )
+	{
+		if( ephemeralPoolSize != 0 )
+			EphemeralPool::Instance( ).Release( this );
+	}
+
 	std::string ECP::AlgorithmName( ) const
 	{
 		return encrypter.AlgorithmName( );
@@ -558,40 +868,146 @@ namespace cryptography
 		{
 			CheckPrivateKey( );
 			CryptoPP::AutoSeededRandomPool prng;
-			decrypted.resize( decrypter.MaxPlaintextLength( encrypted.size( ) ) );
-			CryptoPP::DecodingResult res = decrypter.Decrypt(
-				prng,
-				encrypted.data( ),
-				encrypted.size( ),
-				decrypted.data( )
-			);
-			decrypted.resize( res.messageLength );
+			DecryptWith( decrypter, prng, encrypted, decrypted );
 			return true;
 		}
-		catch( const CryptoPP::Exception &e )
+		catch( const std::exception &e )
 		{
-			SetLastError( e.GetWhat( ) );
+			SetLastError( e.what( ) );
 			return false;
 		}
 	}
 
+	void ECP::DecryptMany( const std::vector<bytes> &encrypted, std::vector<bytes> &decrypted, std::vector<std::string> &errors )
+	{
+		decrypted.assign( encrypted.size( ), bytes( ) );
+		errors.assign( encrypted.size( ), std::string( ) );
+
+		ThreadPool::Instance( ).ParallelFor( encrypted.size( ), [&]( size_t begin, size_t end )
+		{
+			CryptoPP::AutoSeededRandomPool prng;
+			const Decryptor decryptor( decrypter );
+			for( size_t i = begin; i < end; ++i )
+				try
+				{
+					CheckPrivateKey( );
+					DecryptWith( decryptor, prng, encrypted[i], decrypted[i] );
+				}
+				catch( const std::exception &e )
+				{
+					errors[i] = e.what( );
+				}
+		} );
+	}
+
 	bool ECP::Encrypt( const bytes &decrypted, bytes &encrypted )
 	{
 		try
 		{
 			CheckPublicKey( );
+
+			// repeat encryptions to the same recipient amortize a fixed-base table for its key
+			if( !precomputed && precomputeThreshold != 0 && ++encryptions >= precomputeThreshold )
+				PrecomputePublicKey( );
+
 			CryptoPP::AutoSeededRandomPool prng;
 			encrypted.resize( encrypter.CiphertextLength( decrypted.size( ) ) );
-			encrypter.Encrypt( prng, decrypted.data( ), decrypted.size( ), encrypted.data( ) );
+
+			Ephemeral ephemeral;
+			const bool pooled = ephemeralPoolSize != 0 && !curve.Empty( ) &&
+				EphemeralPool::Instance( ).Acquire( curve, ephemeral );
+			if( !pooled && !pubkeyp256 )
+			{
+				encrypter.Encrypt( prng, decrypted.data( ), decrypted.size( ), encrypted.data( ) );
+				return true;
+			}
+
+			if( !pooled )
+			{
+				ephemeral.exponent = CryptoPP::Integer(
+					prng,
+					CryptoPP::Integer::One( ),
+					encrypter.GetKey( ).GetGroupParameters( ).GetMaxExponent( )
+				);
+				ephemeral.element = p256::MultiplyBase( ephemeral.exponent );
+			}
+
+			CryptoPP::ECP::Point agreed;
+			if( !pubkeyp256 )
+				agreed = encrypter.Agree( ephemeral.exponent );
+			else if( pubkeytable )
+				agreed = pubkeytable->Multiply( ephemeral.exponent );
+			else
+				agreed = p256::Multiply( encrypter.GetKey( ).GetPublicElement( ), ephemeral.exponent );
+
+			encrypter.Encrypt( prng, ephemeral, agreed, decrypted.data( ), decrypted.size( ), encrypted.data( ) );
 			return true;
 		}
-		catch( const CryptoPP::Exception &e )
+		catch( const std::exception &e )
 		{
-			SetLastError( e.GetWhat( ) );
+			SetLastError( e.what( ) );
 			return false;
 		}
 	}
 
+	bool ECP::IsPublicKey( ) const
+	{
+		return true;
+	}
+
+	bool ECP::Precompute( )
+	{
+		try
+		{
+			CheckPublicKey( );
+			if( !precomputed )
+				PrecomputePublicKey( );
+
+			return true;
+		}
+		catch( const std::exception &e )
+		{
+			SetLastError( e.what( ) );
+			return false;
+		}
+	}
+
+	bool ECP::SetPrecomputationThreshold( size_t uses )
+	{
+		precomputeThreshold = uses;
+		return true;
+	}
+
+	bool ECP::SetEphemeralPoolSize( size_t size )
+	{
+		ephemeralPoolSize = size;
+		if( !curve.Empty( ) )
+			EphemeralPool::Instance( ).Reserve( this, curve, ephemeralPoolSize );
+
+		return true;
+	}
+
+	void ECP::DecryptWith(
+		const Decryptor &decryptor,
+		CryptoPP::RandomNumberGenerator &prng,
+		const bytes &encrypted,
+		bytes &decrypted
+	) const
+	{
+		decrypted.resize( decryptor.MaxPlaintextLength( encrypted.size( ) ) );
+
+		CryptoPP::DecodingResult res;
+		if( prikeyp256 )
+			res = decryptor.DecryptP256( encrypted.data( ), encrypted.size( ), decrypted.data( ) );
+		else
+			res = decryptor.Decrypt( prng, encrypted.data( ), encrypted.size( ), decrypted.data( ) );
+
+		if( !res.isValidCoding )
+			throw CryptoPP::InvalidCiphertext( "ECIES: ciphertext failed to decode" );
+
+		decrypted.resize( res.messageLength );
+	}
+
 	void ECP::CheckPrivateKey( ) const
 	{
 		if( !prikeyset )
@@ -604,7 +1020,12 @@ namespace cryptography
 	void ECP::SetPrivateKey( const CryptoPP::ECIES<CryptoPP::ECP>::PrivateKey &privKey )
 	{
 		decrypter.AccessKey( ).AssignFrom( privKey );
+		decrypter.AccessKey( ).Precompute( );
 		prikeyset = true;
+
+		CryptoPP::OID privCurve;
+		prikeyp256 = decrypter.GetKey( ).GetGroupParameters( ).GetValue( CryptoPP::Name::GroupOID( ), privCurve ) &&
+			p256::IsCurve( privCurve );
 	}
 
 	void ECP::CheckPublicKey( ) const
@@ -618,7 +1039,101 @@ namespace cryptography
 
 	void ECP::SetPublicKey( const CryptoPP::ECIES<CryptoPP::ECP>::PublicKey &pubKey )
 	{
+		// assigning a new public element discards any table built for the previous one
 		encrypter.AccessKey( ).AssignFrom( pubKey );
 		pubkeyset = true;
+		precomputed = false;
+		encryptions = 0;
+		pubkeytable.reset( );
+
+		// keys with explicit curve parameters have no OID and always take the generic path
+		curve = CryptoPP::OID( );
+		encrypter.GetKey( ).GetGroupParameters( ).GetValue( CryptoPP::Name::GroupOID( ), curve );
+		pubkeyp256 = p256::IsCurve( curve );
+
+		// the share follows the key, a curve without an OID can't be pooled
+		if( curve.Empty( ) )
+			EphemeralPool::Instance( ).Release( this );
+		else if( ephemeralPoolSize != 0 )
+			EphemeralPool::Instance( ).Reserve( this, curve, ephemeralPoolSize );
+	}
+
+	void ECP::PrecomputePublicKey( )
+	{
+		if( pubkeyp256 )
+			pubkeytable.reset( new p256::Table( encrypter.GetKey( ).GetPublicElement( ) ) );
+		else
+			encrypter.AccessKey( ).Precompute( );
+
+		precomputed = true;
+	}
+
+	void ECP::Encryptor::Encrypt(
+		CryptoPP::RandomNumberGenerator &rng,
+		const Ephemeral &ephemeral,
+		const CryptoPP::ECP::Point &agreed,
+		const uint8_t *plaintext,
+		size_t plaintextLength,
+		uint8_t *ciphertext
+	) const
+	{
+		const CryptoPP::DL_KeyDerivationAlgorithm<CryptoPP::ECP::Point> &derivAlg = GetKeyDerivationAlgorithm( );
+		const CryptoPP::DL_SymmetricEncryptionAlgorithm &encAlg = GetSymmetricEncryptionAlgorithm( );
+		const CryptoPP::DL_GroupParameters<CryptoPP::ECP::Point> &params = GetAbstractGroupParameters( );
+
+		params.EncodeElement( true, ephemeral.element, ciphertext );
+		ciphertext += params.GetEncodedElementSize( true );
+
+		CryptoPP::SecByteBlock derivedKey( encAlg.GetSymmetricKeyLength( plaintextLength ) );
+		derivAlg.Derive( params, derivedKey, derivedKey.size( ), agreed, ephemeral.element, CryptoPP::g_nullNameValuePairs );
+
+		encAlg.SymmetricEncrypt( rng, derivedKey, plaintext, plaintextLength, ciphertext, CryptoPP::g_nullNameValuePairs );
+	}
+
+	CryptoPP::ECP::Point ECP::Encryptor::Agree( const CryptoPP::Integer &exponent ) const
+	{
+		return GetKeyAgreementAlgorithm( ).AgreeWithEphemeralPrivateKey(
+			GetAbstractGroupParameters( ),
+			GetKeyInterface( ).GetPublicPrecomputation( ),
+			exponent
+		);
+	}
+
+	CryptoPP::DecodingResult ECP::Decryptor::DecryptP256(
+		const uint8_t *ciphertext,
+		size_t ciphertextLength,
+		uint8_t *plaintext
+	) const
+	{
+		const CryptoPP::DL_KeyDerivationAlgorithm<CryptoPP::ECP::Point> &derivAlg = GetKeyDerivationAlgorithm( );
+		const CryptoPP::DL_SymmetricEncryptionAlgorithm &encAlg = GetSymmetricEncryptionAlgorithm( );
+		const CryptoPP::DL_GroupParameters<CryptoPP::ECP::Point> &params = GetAbstractGroupParameters( );
+
+		const size_t elementSize = params.GetEncodedElementSize( true );
+		if( ciphertextLength < elementSize )
+			return CryptoPP::DecodingResult( );
+
+		try
+		{
+			// P-256 has cofactor 1, so an affine point on the curve is already in the prime order
+			// subgroup and the full ValidateElement multiplication by the order is not needed
+			CryptoPP::ECP::Point q = params.DecodeElement( ciphertext, true );
+			if( q.identity || !GetKey( ).GetGroupParameters( ).GetCurve( ).VerifyPoint( q ) )
+				return CryptoPP::DecodingResult( );
+
+			ciphertext += elementSize;
+			ciphertextLength -= elementSize;
+
+			CryptoPP::ECP::Point z = p256::Multiply( q, GetKeyInterface( ).GetPrivateExponent( ) );
+
+			CryptoPP::SecByteBlock derivedKey( encAlg.GetSymmetricKeyLength( encAlg.GetMaxSymmetricPlaintextLength( ciphertextLength ) ) );
+			derivAlg.Derive( params, derivedKey, derivedKey.size( ), z, q, CryptoPP::g_nullNameValuePairs );
+
+			return encAlg.SymmetricDecrypt( derivedKey, ciphertext, ciphertextLength, plaintext, CryptoPP::g_nullNameValuePairs );
+		}
+		catch( const CryptoPP::DL_BadElement & )
+		{
+			return CryptoPP::DecodingResult( );
+		}
 	}
 }
@@ -8,8 +8,14 @@
 #include <cryptopp/aes.h>
 #include <cryptopp/gcm.h>
 #include <cryptopp/rsa.h>
+#include <cryptopp/modarith.h>
 #include <cryptopp/osrng.h>
 #include <cryptopp/eccrypto.h>
+#include <ephemeral.hpp>
+#include <p256.hpp>
+#include <montgomery.hpp>
+#include <threadpool.hpp>
+#include <memory>
 
 namespace cryptography
 {
@@ -20,6 +26,8 @@ namespace cryptography
 	class Crypter
 	{
 	public:
+		virtual ~Crypter( ) { }
+
 		virtual std::string AlgorithmName( ) const = 0;
 
 		virtual size_t MaxPlaintextLength( size_t length ) const = 0;
@@ -47,6 +55,25 @@ namespace cryptography
 
 		virtual bool Encrypt( const bytes &data, bytes &encrypted ) = 0;
 
+		// Decrypts every element independently, errors[i] is empty when decrypted[i] succeeded.
+		virtual void DecryptMany(
+			const std::vector<bytes> &data,
+			std::vector<bytes> &decrypted,
+			std::vector<std::string> &errors
+		);
+
+		virtual bool Precompute( );
+
+		virtual bool SetPrecomputationThreshold( size_t uses );
+
+		virtual bool SetEphemeralPoolSize( size_t size );
+
+		virtual bool SetLatencyMode( bool enabled );
+
+		// True when encrypting only needs a key that can be handed out. Symmetric crypters share
+		// their one key and IV with whoever can decrypt.
+		virtual bool IsPublicKey( ) const;
+
 		inline const std::string &GetLastError( ) const
 		{
 			return lasterror;
@@ -142,7 +169,73 @@ namespace cryptography
 
 		bool Encrypt( const bytes &decrypted, bytes &encrypted );
 
+		bool IsPublicKey( ) const;
+
+		void DecryptMany(
+			const std::vector<bytes> &encrypted,
+			std::vector<bytes> &decrypted,
+			std::vector<std::string> &errors
+		);
+
+		bool SetLatencyMode( bool enabled );
+
 	private:
+		// Private key whose CRT exponentiations run on the MULX/ADX Montgomery kernel when it wins.
+		// Precompute keeps the Montgomery contexts of p and q alive between operations, ours or
+		// Integer's depending on the size, and latency mode runs the q half on the shared thread pool.
+		class PrivateKey : public CryptoPP::InvertibleRSAFunction
+		{
+		public:
+			PrivateKey( );
+
+			void SetLatencyMode( bool enabled );
+
+			bool SupportsPrecomputation( ) const
+			{
+				return true;
+			}
+
+			void Precompute( unsigned int precomputationStorage = 0 );
+
+			CryptoPP::Integer CalculateInverse( CryptoPP::RandomNumberGenerator &rng, const CryptoPP::Integer &x ) const;
+
+		private:
+			// only one of the two is set, whichever multiplier is faster for the modulus
+			struct Context
+			{
+				std::shared_ptr<const Montgomery> fast;
+				std::shared_ptr<const CryptoPP::MontgomeryRepresentation> generic;
+			};
+
+			static CryptoPP::Integer ExponentiateHalf(
+				const Context &context,
+				const CryptoPP::Integer &x,
+				const CryptoPP::Integer &exponent,
+				const CryptoPP::Integer &modulus
+			);
+
+			bool latency;
+			Context modp;
+			Context modq;
+		};
+
+		struct Keys
+		{
+			static const char *StaticAlgorithmName( )
+			{
+				return "RSA";
+			}
+
+			typedef CryptoPP::RSAFunction PublicKey;
+			typedef RSA::PrivateKey PrivateKey;
+		};
+
+		void DecryptWith(
+			CryptoPP::RandomNumberGenerator &prng,
+			const bytes &encrypted,
+			bytes &decrypted
+		) const;
+
 		void CheckPrivateKey( ) const;
 
 		void SetPrivateKey( const CryptoPP::RSA::PrivateKey &privKey );
@@ -153,7 +246,7 @@ namespace cryptography
 
 		bool prikeyset;
 		bool pubkeyset;
-		CryptoPP::RSAES_OAEP_SHA_Decryptor decrypter;
+		CryptoPP::TF_ES<Keys, CryptoPP::OAEP<CryptoPP::SHA1> >::Decryptor decrypter;
 		CryptoPP::RSAES_OAEP_SHA_Encryptor encrypter;
 	};
 
@@ -161,6 +254,7 @@ namespace cryptography
 	{
 	public:
 		ECP( );
+		~ECP( );
 
 		std::string AlgorithmName( ) const;
 
@@ -189,7 +283,58 @@ namespace cryptography
 
 		bool Encrypt( const bytes &decrypted, bytes &encrypted );
 
+		bool IsPublicKey( ) const;
+
+		void DecryptMany(
+			const std::vector<bytes> &encrypted,
+			std::vector<bytes> &decrypted,
+			std::vector<std::string> &errors
+		);
+
+		bool Precompute( );
+
+		bool SetPrecomputationThreshold( size_t uses );
+
+		bool SetEphemeralPoolSize( size_t size );
+
 	private:
+		class Encryptor : public CryptoPP::ECIES<CryptoPP::ECP>::Encryptor
+		{
+		public:
+			using CryptoPP::ECIES<CryptoPP::ECP>::Encryptor::Encrypt;
+
+			// same as the ECIES encryption but with a given ephemeral keypair and shared secret
+			void Encrypt(
+				CryptoPP::RandomNumberGenerator &rng,
+				const Ephemeral &ephemeral,
+				const CryptoPP::ECP::Point &agreed,
+				const uint8_t *plaintext,
+				size_t plaintextLength,
+				uint8_t *ciphertext
+			) const;
+
+			CryptoPP::ECP::Point Agree( const CryptoPP::Integer &exponent ) const;
+		};
+
+		class Decryptor : public CryptoPP::ECIES<CryptoPP::ECP>::Decryptor
+		{
+		public:
+			// same as the ECIES decryption but with the shared secret computed by the P-256 backend
+			CryptoPP::DecodingResult DecryptP256(
+				const uint8_t *ciphertext,
+				size_t ciphertextLength,
+				uint8_t *plaintext
+			) const;
+		};
+
+		// Crypto++ curves keep scratch state, concurrent callers each need their own decryptor
+		void DecryptWith(
+			const Decryptor &decryptor,
+			CryptoPP::RandomNumberGenerator &prng,
+			const bytes &encrypted,
+			bytes &decrypted
+		) const;
+
 		void CheckPrivateKey( ) const;
 
 		void SetPrivateKey( const CryptoPP::ECIES<CryptoPP::ECP>::PrivateKey &privKey );
@@ -198,9 +343,19 @@ namespace cryptography
 
 		void SetPublicKey( const CryptoPP::ECIES<CryptoPP::ECP>::PublicKey &pubKey );
 
+		void PrecomputePublicKey( );
+
 		bool prikeyset;
 		bool pubkeyset;
-		CryptoPP::ECIES<CryptoPP::ECP>::Decryptor decrypter;
-		CryptoPP::ECIES<CryptoPP::ECP>::Encryptor encrypter;
+		bool prikeyp256;
+		bool pubkeyp256;
+		bool precomputed;
+		size_t precomputeThreshold;
+		size_t encryptions;
+		size_t ephemeralPoolSize;
+		CryptoPP::OID curve;
+		std::unique_ptr<p256::Table> pubkeytable;
+		Decryptor decrypter;
+		Encryptor encrypter;
 	};
 }
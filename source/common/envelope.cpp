@@ -0,0 +1,173 @@
+#include <envelope.hpp>
+#include <threadpool.hpp>
+
+#include <unordered_map>
+
+namespace cryptography
+{
+	namespace
+	{
+		static const size_t KeyLength = 32;
+		static const size_t NonceLength = 12;
+		static const size_t TagLength = 16;
+
+		static const char *SymmetricError = "envelope recipients need a public key crypter";
+
+		// Crypter takes and returns keys as plain bytes, this wipes such a copy when it goes out
+		// of scope.
+		class WipeOnExit
+		{
+		public:
+			explicit WipeOnExit( bytes &buffer ) :
+				buffer( buffer )
+			{ }
+
+			~WipeOnExit( )
+			{
+				CryptoPP::SecureWipeArray( buffer.data( ), buffer.size( ) );
+			}
+
+		private:
+			bytes &buffer;
+		};
+	}
+
+	bool Seal(
+		const bytes &data,
+		const std::vector<Crypter *> &recipients,
+		bytes &body,
+		std::vector<bytes> &headers,
+		std::vector<std::string> &errors,
+		std::string &error
+	)
+	{
+		CryptoPP::SecByteBlock key( KeyLength );
+		try
+		{
+			CryptoPP::AutoSeededRandomPool prng;
+			prng.GenerateBlock( key, key.size( ) );
+
+			body.resize( NonceLength + data.size( ) + TagLength );
+			prng.GenerateBlock( body.data( ), NonceLength );
+
+			CryptoPP::GCM<CryptoPP::AES>::Encryption gcm;
+			gcm.SetKeyWithIV( key, key.size( ), body.data( ), NonceLength );
+			gcm.EncryptAndAuthenticate(
+				body.data( ) + NonceLength,
+				body.data( ) + NonceLength + data.size( ),
+				TagLength,
+				body.data( ),
+				NonceLength,
+				nullptr,
+				0,
+				data.data( ),
+				data.size( )
+			);
+		}
+		catch( const CryptoPP::Exception &e )
+		{
+			error = e.GetWhat( );
+			return false;
+		}
+
+		// a crypter is not safe to use from two threads, so each one wraps the key once
+		std::vector<Crypter *> unique;
+		std::unordered_map<Crypter *, size_t> slots;
+		std::vector<size_t> slot( recipients.size( ) );
+		for( size_t i = 0; i < recipients.size( ); ++i )
+		{
+			auto it = slots.emplace( recipients[i], unique.size( ) ).first;
+			if( it->second == unique.size( ) )
+				unique.push_back( recipients[i] );
+
+			slot[i] = it->second;
+		}
+
+		// a symmetric recipient would wrap every envelope with the same key and IV
+		bytes plainKey( key.begin( ), key.end( ) );
+		const WipeOnExit wipe( plainKey );
+		std::vector<bytes> wrapped( unique.size( ) );
+		std::vector<std::string> failures( unique.size( ) );
+		ThreadPool::Instance( ).ParallelFor( unique.size( ), [&]( size_t begin, size_t end )
+		{
+			for( size_t i = begin; i < end; ++i )
+				if( !unique[i]->IsPublicKey( ) )
+					failures[i] = SymmetricError;
+				else if( !unique[i]->Encrypt( plainKey, wrapped[i] ) )
+				{
+					wrapped[i].clear( );
+					failures[i] = unique[i]->GetLastError( );
+				}
+		} );
+
+		headers.resize( recipients.size( ) );
+		errors.resize( recipients.size( ) );
+		for( size_t i = 0; i < recipients.size( ); ++i )
+		{
+			headers[i] = wrapped[slot[i]];
+			errors[i] = failures[slot[i]];
+		}
+
+		return true;
+	}
+
+	bool Open( Crypter &recipient, const bytes &header, const bytes &body, bytes &data, std::string &error )
+	{
+		if( !recipient.IsPublicKey( ) )
+		{
+			error = SymmetricError;
+			return false;
+		}
+
+		CryptoPP::SecByteBlock key;
+		{
+			bytes unwrapped;
+			const WipeOnExit wipe( unwrapped );
+			if( !recipient.Decrypt( header, unwrapped ) )
+			{
+				error = recipient.GetLastError( );
+				return false;
+			}
+
+			key.Assign( unwrapped.data( ), unwrapped.size( ) );
+		}
+
+		if( key.size( ) != KeyLength || body.size( ) < NonceLength + TagLength )
+		{
+			error = "envelope header or body is malformed";
+			return false;
+		}
+
+		try
+		{
+			const size_t length = body.size( ) - NonceLength - TagLength;
+			data.resize( length );
+
+			CryptoPP::GCM<CryptoPP::AES>::Decryption gcm;
+			gcm.SetKeyWithIV( key, key.size( ), body.data( ), NonceLength );
+			if( !gcm.DecryptAndVerify(
+				data.data( ),
+				body.data( ) + NonceLength + length,
+				TagLength,
+				body.data( ),
+				NonceLength,
+				nullptr,
+				0,
+				body.data( ) + NonceLength,
+				length
+			) )
+			{
+				data.clear( );
+				error = "envelope body failed authentication";
+				return false;
+			}
+
+			return true;
+		}
+		catch( const CryptoPP::Exception &e )
+		{
+			error = e.GetWhat( );
+			return false;
+		}
+	}
+}
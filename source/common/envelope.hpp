@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cryptography.hpp>
+
+namespace cryptography
+{
+	// Multi-recipient encryption: the body is encrypted once under a random AES-256-GCM key
+	// (nonce, ciphertext and tag) and only that key is encrypted for each recipient.
+
+	// Wraps the content key with every recipient crypter concurrently. headers[i] holds the key
+	// wrapped for recipients[i], or stays empty with errors[i] set. Recipients must be public key
+	// crypters (RSA, ECP), symmetric ones are refused. Recipients listed more than once are only
+	// used once. Returns false with error set when the body can't be encrypted.
+	bool Seal(
+		const bytes &data,
+		const std::vector<Crypter *> &recipients,
+		bytes &body,
+		std::vector<bytes> &headers,
+		std::vector<std::string> &errors,
+		std::string &error
+	);
+
+	// Unwraps the content key from header with the recipient's private key and decrypts body.
+	bool Open( Crypter &recipient, const bytes &header, const bytes &body, bytes &data, std::string &error );
+}
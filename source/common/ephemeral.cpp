@@ -0,0 +1,180 @@
+#include <ephemeral.hpp>
+#include <p256.hpp>
+
+#include <cryptopp/osrng.h>
+
+namespace cryptography
+{
+	EphemeralPool &EphemeralPool::Instance( )
+	{
+		static EphemeralPool pool;
+		return pool;
+	}
+
+	EphemeralPool::EphemeralPool( ) :
+		stopping( false )
+	{ }
+
+	EphemeralPool::~EphemeralPool( )
+	{
+		Shutdown( );
+	}
+
+	void EphemeralPool::Reserve( const void *owner, const CryptoPP::OID &curve, size_t capacity )
+	{
+		std::lock_guard<std::mutex> lock( mutex );
+
+		Unreserve( owner );
+		if( capacity == 0 )
+			return;
+
+		Queue &queue = queues[curve];
+		queue.shares[owner] = capacity;
+		queue.capacity += capacity;
+
+		if( !worker.joinable( ) )
+			worker = std::thread( &EphemeralPool::Work, this );
+	}
+
+	void EphemeralPool::Release( const void *owner )
+	{
+		std::lock_guard<std::mutex> lock( mutex );
+		Unreserve( owner );
+	}
+
+	bool EphemeralPool::Acquire( const CryptoPP::OID &curve, Ephemeral &ephemeral )
+	{
+		std::lock_guard<std::mutex> lock( mutex );
+
+		auto it = queues.find( curve );
+		if( it == queues.end( ) )
+			return false;
+
+		it->second.demanded = true;
+		wakeup.notify_one( );
+
+		std::deque<Ephemeral> &ready = it->second.ready;
+		if( ready.empty( ) )
+			return false;
+
+		ephemeral = std::move( ready.front( ) );
+		ready.pop_front( );
+		return true;
+	}
+
+	void EphemeralPool::Shutdown( )
+	{
+		{
+			std::lock_guard<std::mutex> lock( mutex );
+			stopping = true;
+			wakeup.notify_one( );
+		}
+
+		if( worker.joinable( ) )
+			worker.join( );
+
+		std::lock_guard<std::mutex> lock( mutex );
+		queues.clear( );
+		stopping = false;
+	}
+
+	void EphemeralPool::Unreserve( const void *owner )
+	{
+		for( auto it = queues.begin( ); it != queues.end( ); ++it )
+		{
+			Queue &queue = it->second;
+			auto share = queue.shares.find( owner );
+			if( share == queue.shares.end( ) )
+				continue;
+
+			queue.capacity -= share->second;
+			queue.shares.erase( share );
+			if( queue.shares.empty( ) )
+				queues.erase( it );
+			else if( queue.ready.size( ) > queue.capacity )
+				queue.ready.resize( queue.capacity );
+
+			// an owner only ever holds one share
+			return;
+		}
+	}
+
+	void EphemeralPool::Work( )
+	{
+		CryptoPP::AutoSeededRandomPool prng;
+
+		// the worker owns its group parameters, Crypto++ curves are not safe to share across threads
+		std::map<CryptoPP::OID, CryptoPP::DL_GroupParameters_EC<CryptoPP::ECP>> groups;
+
+		std::unique_lock<std::mutex> lock( mutex );
+		while( !stopping )
+		{
+			CryptoPP::OID curve;
+			if( !FindStarved( curve ) )
+			{
+				wakeup.wait( lock );
+				continue;
+			}
+
+			lock.unlock( );
+
+			Ephemeral ephemeral;
+			bool generated = false;
+			try
+			{
+				const bool fast = p256::IsCurve( curve );
+				auto it = groups.find( curve );
+				if( it == groups.end( ) )
+				{
+					it = groups.emplace( curve, curve ).first;
+					if( !fast )
+						it->second.Precompute( );
+				}
+
+				const CryptoPP::DL_GroupParameters_EC<CryptoPP::ECP> &params = it->second;
+				ephemeral.exponent = CryptoPP::Integer( prng, CryptoPP::Integer::One( ), params.GetMaxExponent( ) );
+				if( fast )
+					ephemeral.element = p256::MultiplyBase( ephemeral.exponent );
+				else
+					ephemeral.element = params.ExponentiateBase( ephemeral.exponent );
+
+				generated = true;
+			}
+			catch( const std::exception & )
+			{ }
+
+			lock.lock( );
+
+			auto it = queues.find( curve );
+			if( it == queues.end( ) )
+				continue;
+
+			// a curve we can't generate for is dropped, encryptions fall back to inline keypairs
+			if( !generated )
+			{
+				queues.erase( it );
+				continue;
+			}
+
+			Queue &queue = it->second;
+			if( queue.ready.size( ) < queue.capacity )
+				queue.ready.push_back( std::move( ephemeral ) );
+
+			// full again, park until an Acquire shows the curve is still being used
+			if( queue.ready.size( ) >= queue.capacity )
+				queue.demanded = false;
+		}
+	}
+
+	bool EphemeralPool::FindStarved( CryptoPP::OID &curve ) const
+	{
+		for( const auto &pair : queues )
+			if( pair.second.demanded && pair.second.ready.size( ) < pair.second.capacity )
+			{
+				curve = pair.first;
+				return true;
+			}
+
+		return false;
+	}
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <cryptopp/eccrypto.h>
+
+namespace cryptography
+{
+	struct Ephemeral
+	{
+		CryptoPP::Integer exponent;
+		CryptoPP::ECP::Point element;
+	};
+
+	// Pre-generates ECIES ephemeral keypairs on a background thread, one bounded queue per curve.
+	// Each crypter reserves its share of a curve's queue, the capacity is the sum of the shares
+	// and the queue goes away with the last one. A queue is only refilled after Acquire shows it
+	// is in use, the worker sleeps otherwise.
+	class EphemeralPool
+	{
+	public:
+		static EphemeralPool &Instance( );
+
+		// Sets the owner's share of the curve's queue, moving it off any curve it held before and
+		// dropping queued keypairs past the new capacity. Zero releases the share.
+		void Reserve( const void *owner, const CryptoPP::OID &curve, size_t capacity );
+
+		// Releases the owner's share, whichever curve it was on.
+		void Release( const void *owner );
+
+		// Pops a ready keypair for the curve without blocking, false if none is queued. Either way
+		// the curve is marked in demand and the worker tops its queue back up.
+		bool Acquire( const CryptoPP::OID &curve, Ephemeral &ephemeral );
+
+		// Stops and joins the worker, dropping every queued keypair.
+		void Shutdown( );
+
+	private:
+		struct Queue
+		{
+			Queue( ) :
+				capacity( 0 ),
+				demanded( false )
+			{ }
+
+			size_t capacity;
+			bool demanded;
+			std::map<const void *, size_t> shares;
+			std::deque<Ephemeral> ready;
+		};
+
+		EphemeralPool( );
+		~EphemeralPool( );
+
+		// caller holds the mutex
+		void Unreserve( const void *owner );
+
+		void Work( );
+
+		bool FindStarved( CryptoPP::OID &curve ) const;
+
+		std::mutex mutex;
+		std::condition_variable wakeup;
+		std::thread worker;
+		bool stopping;
+		std::map<CryptoPP::OID, Queue> queues;
+	};
+}
@@ -0,0 +1,33 @@
+#include <hashstate.hpp>
+
+namespace cryptography
+{
+	namespace
+	{
+		static const uint8_t StateVersion = 1;
+	}
+
+	std::string HashStateAlgorithm( const bytes &state )
+	{
+		if( state.size( ) < 2 || state[0] != StateVersion || state.size( ) < 2u + state[1] )
+			throw CryptoPP::InvalidDataFormat( "hash state is malformed or from an unsupported version" );
+
+		return std::string( state.begin( ) + 2, state.begin( ) + 2 + state[1] );
+	}
+
+	void WriteHashStateHeader( const std::string &name, bytes &state )
+	{
+		state.clear( );
+		state.push_back( StateVersion );
+		state.push_back( static_cast<uint8_t>( name.size( ) ) );
+		state.insert( state.end( ), name.begin( ), name.end( ) );
+	}
+
+	size_t ReadHashStateHeader( const std::string &name, const bytes &state )
+	{
+		if( HashStateAlgorithm( state ) != name )
+			throw CryptoPP::InvalidDataFormat( name + ": hash state belongs to another algorithm" );
+
+		return 2 + name.size( );
+	}
+}
@@ -0,0 +1,214 @@
+#pragma once
+
+#include <cryptography.hpp>
+#include <cryptopp/iterhash.h>
+#include <cryptopp/misc.h>
+#include <cstring>
+
+namespace cryptography
+{
+	// A hash whose progress can be saved and resumed later, in another process if need be.
+	// States start with a version byte and the algorithm name, followed by what the algorithm
+	// needs to continue. They carry no integrity protection.
+	class ResumableHash
+	{
+	public:
+		virtual ~ResumableHash( ) { }
+
+		virtual void ExportState( bytes &state ) const = 0;
+
+		// Continues from a state exported by the same algorithm, throws
+		// CryptoPP::InvalidDataFormat for anything else.
+		virtual void ImportState( const bytes &state ) = 0;
+	};
+
+	// Algorithm name a state was exported from, throws CryptoPP::InvalidDataFormat when the
+	// header is malformed.
+	std::string HashStateAlgorithm( const bytes &state );
+
+	// Starts a state with the header for name.
+	void WriteHashStateHeader( const std::string &name, bytes &state );
+
+	// Checks the header against name and returns where the algorithm's part begins.
+	size_t ReadHashStateHeader( const std::string &name, const bytes &state );
+
+	// SHA-1 and SHA-2 with their block bookkeeping done here instead of in Crypto++'s
+	// IteratedHashBase, which keeps the message length private. Blocks are still compressed
+	// by the Crypto++ code, so the SHA-NI and SSE paths are kept. StateSize is the size of the
+	// chaining value in bytes. The state holds the big endian byte count, the chaining value and
+	// the bytes of the partial block.
+	template<typename Hash, unsigned int StateSize>
+	class ResumableIteratedHash : public Hash, public ResumableHash
+	{
+	public:
+		typedef typename Hash::HashWordType HashWordType;
+
+		ResumableIteratedHash( ) :
+			count( 0 )
+		{ }
+
+		void Update( const CryptoPP::byte *input, size_t length )
+		{
+			if( length == 0 )
+				return;
+
+			const unsigned int blockSize = this->BlockSize( );
+			size_t num = static_cast<size_t>( count % blockSize );
+			const CryptoPP::word64 total = count + length;
+			if( total < count || ( sizeof( HashWordType ) == 4 && ( total >> 61 ) != 0 ) )
+				throw CryptoPP::HashInputTooLong( this->AlgorithmName( ) );
+
+			count = total;
+
+			HashWordType *dataBuf = this->DataBuf( );
+			CryptoPP::byte *data = reinterpret_cast<CryptoPP::byte *>( dataBuf );
+			if( num != 0 )
+			{
+				if( num + length < blockSize )
+				{
+					std::memcpy( data + num, input, length );
+					return;
+				}
+
+				std::memcpy( data + num, input, blockSize - num );
+				this->HashBlock( dataBuf );
+				input += blockSize - num;
+				length -= blockSize - num;
+			}
+
+			if( length >= blockSize )
+			{
+				if( CryptoPP::IsAligned<HashWordType>( input ) )
+				{
+					const size_t leftOver = this->HashMultipleBlocks( reinterpret_cast<const HashWordType *>( input ), length );
+					input += length - leftOver;
+					length = leftOver;
+				}
+				else
+				{
+					do
+					{
+						std::memcpy( data, input, blockSize );
+						this->HashBlock( dataBuf );
+						input += blockSize;
+						length -= blockSize;
+					}
+					while( length >= blockSize );
+				}
+			}
+
+			std::memcpy( data, input, length );
+		}
+
+		CryptoPP::byte *CreateUpdateSpace( size_t &size )
+		{
+			const unsigned int blockSize = this->BlockSize( );
+			const size_t num = static_cast<size_t>( count % blockSize );
+			size = blockSize - num;
+			return reinterpret_cast<CryptoPP::byte *>( this->DataBuf( ) ) + num;
+		}
+
+		void TruncatedFinal( CryptoPP::byte *digest, size_t size )
+		{
+			this->ThrowIfInvalidTruncatedSize( size );
+
+			const unsigned int blockSize = this->BlockSize( );
+			const unsigned int lastBlockSize = blockSize - 2 * sizeof( HashWordType );
+			const unsigned int words = blockSize / sizeof( HashWordType );
+			const CryptoPP::ByteOrder order = this->GetByteOrder( );
+			HashWordType *dataBuf = this->DataBuf( );
+			HashWordType *stateBuf = this->StateBuf( );
+			CryptoPP::byte *data = reinterpret_cast<CryptoPP::byte *>( dataBuf );
+
+			size_t num = static_cast<size_t>( count % blockSize );
+			data[num++] = 0x80;
+			if( num <= lastBlockSize )
+			{
+				std::memset( data + num, 0, lastBlockSize - num );
+			}
+			else
+			{
+				std::memset( data + num, 0, blockSize - num );
+				this->HashBlock( dataBuf );
+				std::memset( data, 0, lastBlockSize );
+			}
+
+			// the bit count as two words, low one last for big endian hashes
+			const HashWordType bitsLo = static_cast<HashWordType>( count << 3 );
+			const HashWordType bitsHi = static_cast<HashWordType>( count >> ( 8 * sizeof( HashWordType ) - 3 ) );
+			dataBuf[words - 2 + order] = CryptoPP::ConditionalByteReverse( order, bitsLo );
+			dataBuf[words - 1 - order] = CryptoPP::ConditionalByteReverse( order, bitsHi );
+			this->HashBlock( dataBuf );
+
+			CryptoPP::ConditionalByteReverse<HashWordType>( order, stateBuf, stateBuf, this->DigestSize( ) );
+			std::memcpy( digest, stateBuf, size );
+
+			Restart( );
+		}
+
+		void Restart( )
+		{
+			Hash::Restart( );
+			count = 0;
+		}
+
+		ResumableIteratedHash *Clone( ) const
+		{
+			return new ResumableIteratedHash( *this );
+		}
+
+		void ExportState( bytes &state ) const
+		{
+			const unsigned int blockSize = this->BlockSize( );
+			const size_t num = static_cast<size_t>( count % blockSize );
+			const HashWordType *stateBuf = this->m_state;
+			const CryptoPP::byte *data = reinterpret_cast<const CryptoPP::byte *>( static_cast<const HashWordType *>( this->m_data ) );
+
+			bytes result;
+			WriteHashStateHeader( this->AlgorithmName( ), result );
+
+			const size_t offset = result.size( );
+			result.resize( offset + 8 + StateSize + num );
+			CryptoPP::PutWord( false, CryptoPP::BIG_ENDIAN_ORDER, &result[offset], count );
+			for( size_t i = 0; i < StateSize / sizeof( HashWordType ); ++i )
+				CryptoPP::PutWord(
+					false,
+					CryptoPP::BIG_ENDIAN_ORDER,
+					&result[offset + 8 + i * sizeof( HashWordType )],
+					stateBuf[i]
+				);
+
+			std::copy( data, data + num, result.begin( ) + offset + 8 + StateSize );
+			state.swap( result );
+		}
+
+		void ImportState( const bytes &state )
+		{
+			const size_t offset = ReadHashStateHeader( this->AlgorithmName( ), state );
+			if( state.size( ) < offset + 8 + StateSize )
+				throw CryptoPP::InvalidDataFormat( this->AlgorithmName( ) + ": hash state is truncated" );
+
+			const CryptoPP::word64 imported =
+				CryptoPP::GetWord<CryptoPP::word64>( false, CryptoPP::BIG_ENDIAN_ORDER, &state[offset] );
+			const size_t num = static_cast<size_t>( imported % this->BlockSize( ) );
+			if( state.size( ) != offset + 8 + StateSize + num ||
+				( sizeof( HashWordType ) == 4 && ( imported >> 61 ) != 0 ) )
+				throw CryptoPP::InvalidDataFormat( this->AlgorithmName( ) + ": hash state has the wrong size" );
+
+			HashWordType *stateBuf = this->StateBuf( );
+			for( size_t i = 0; i < StateSize / sizeof( HashWordType ); ++i )
+				stateBuf[i] = CryptoPP::GetWord<HashWordType>(
+					false,
+					CryptoPP::BIG_ENDIAN_ORDER,
+					&state[offset + 8 + i * sizeof( HashWordType )]
+				);
+
+			const CryptoPP::byte *pending = &state[offset + 8 + StateSize];
+			std::copy( pending, pending + num, reinterpret_cast<CryptoPP::byte *>( this->DataBuf( ) ) );
+			count = imported;
+		}
+
+	private:
+		CryptoPP::word64 count;
+	};
+}
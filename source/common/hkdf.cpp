@@ -0,0 +1,150 @@
+#include <hkdf.hpp>
+
+namespace cryptography
+{
+	namespace
+	{
+		static const size_t MaxBlocks = 255;
+	}
+
+	HKDF::HKDF( ) :
+		keyset( false ),
+		capacity( 0 )
+	{ }
+
+	bool HKDF::SetKey( const bytes &master, const bytes &salt )
+	{
+		try
+		{
+			// an absent salt is a block of zeros as long as the hash output
+			CryptoPP::SecByteBlock prk( CryptoPP::SHA256::DIGESTSIZE );
+			const bytes zeros( CryptoPP::SHA256::DIGESTSIZE, 0 );
+			const bytes &extractSalt = salt.empty( ) ? zeros : salt;
+			CryptoPP::HMAC<CryptoPP::SHA256>( extractSalt.data( ), extractSalt.size( ) ).CalculateDigest(
+				prk,
+				master.data( ),
+				master.size( )
+			);
+
+			expander.SetKey( prk, prk.size( ) );
+			keyset = true;
+			entries.clear( );
+			cache.clear( );
+			return true;
+		}
+		catch( const CryptoPP::Exception &e )
+		{
+			SetLastError( e.GetWhat( ) );
+			return false;
+		}
+	}
+
+	bool HKDF::Derive( const bytes &info, size_t size, bytes &derived )
+	{
+		std::vector<bytes> results;
+		if( !DeriveMany( std::vector<bytes>( 1, info ), size, results ) )
+			return false;
+
+		derived.swap( results[0] );
+		return true;
+	}
+
+	bool HKDF::DeriveMany( const std::vector<bytes> &infos, size_t size, std::vector<bytes> &derived )
+	{
+		if( !keyset )
+		{
+			SetLastError( "HKDF key was not set" );
+			return false;
+		}
+
+		if( size == 0 || size > MaxBlocks * CryptoPP::SHA256::DIGESTSIZE )
+		{
+			SetLastError( "Invalid HKDF output length" );
+			return false;
+		}
+
+		try
+		{
+			std::vector<bytes> results( infos.size( ) );
+			for( size_t i = 0; i < infos.size( ); ++i )
+			{
+				if( capacity == 0 )
+				{
+					Expand( infos[i], size, results[i] );
+					continue;
+				}
+
+				const std::string key( infos[i].begin( ), infos[i].end( ) );
+				auto it = cache.find( key );
+				if( it != cache.end( ) && it->second->derived.size( ) == size )
+				{
+					entries.splice( entries.begin( ), entries, it->second );
+					results[i] = it->second->derived;
+					continue;
+				}
+
+				Expand( infos[i], size, results[i] );
+
+				if( it != cache.end( ) )
+				{
+					it->second->derived = results[i];
+					entries.splice( entries.begin( ), entries, it->second );
+					continue;
+				}
+
+				entries.push_front( Entry { key, results[i] } );
+				cache.emplace( key, entries.begin( ) );
+				Trim( );
+			}
+
+			derived.swap( results );
+			return true;
+		}
+		catch( const CryptoPP::Exception &e )
+		{
+			SetLastError( e.GetWhat( ) );
+			return false;
+		}
+	}
+
+	void HKDF::SetCacheSize( size_t size )
+	{
+		capacity = size;
+		Trim( );
+	}
+
+	size_t HKDF::GetCacheSize( ) const
+	{
+		return capacity;
+	}
+
+	void HKDF::Expand( const bytes &info, size_t size, bytes &derived )
+	{
+		// T(i) = HMAC( PRK, T(i - 1) | info | i ), the output is T(1) | T(2) | ... cut to size
+		derived.resize( size );
+		CryptoPP::byte block[CryptoPP::SHA256::DIGESTSIZE];
+		for( size_t offset = 0, counter = 1; offset < size; offset += sizeof( block ), ++counter )
+		{
+			if( offset != 0 )
+				expander.Update( block, sizeof( block ) );
+
+			const CryptoPP::byte index = static_cast<CryptoPP::byte>( counter );
+			expander.Update( info.data( ), info.size( ) );
+			expander.Update( &index, 1 );
+			expander.Final( block );
+
+			std::copy( block, block + std::min( sizeof( block ), size - offset ), derived.begin( ) + offset );
+		}
+
+		CryptoPP::SecureWipeArray( block, sizeof( block ) );
+	}
+
+	void HKDF::Trim( )
+	{
+		while( entries.size( ) > capacity )
+		{
+			cache.erase( entries.back( ).info );
+			entries.pop_back( );
+		}
+	}
+}
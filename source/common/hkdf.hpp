@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cryptography.hpp>
+#include <cryptopp/hmac.h>
+#include <cryptopp/sha.h>
+#include <list>
+#include <unordered_map>
+
+namespace cryptography
+{
+	// HKDF-SHA256 (RFC 5869) over one master key. The extract step runs once when the key is
+	// set, each derivation only runs the expand step with an HMAC already keyed with the
+	// pseudorandom key. Derived keys can be kept in a least recently used cache keyed by info.
+	class HKDF
+	{
+	public:
+		HKDF( );
+
+		bool SetKey( const bytes &master, const bytes &salt );
+
+		bool Derive( const bytes &info, size_t size, bytes &derived );
+
+		// Derives one key per info, derived[i] belongs to infos[i].
+		bool DeriveMany( const std::vector<bytes> &infos, size_t size, std::vector<bytes> &derived );
+
+		// Number of derived keys remembered, 0 (the default) disables the cache.
+		void SetCacheSize( size_t size );
+
+		size_t GetCacheSize( ) const;
+
+		inline const std::string &GetLastError( ) const
+		{
+			return lasterror;
+		}
+
+	private:
+		struct Entry
+		{
+			std::string info;
+			bytes derived;
+		};
+
+		void Expand( const bytes &info, size_t size, bytes &derived );
+
+		void Trim( );
+
+		inline void SetLastError( const std::string &err )
+		{
+			lasterror = err;
+		}
+
+		bool keyset;
+		CryptoPP::HMAC<CryptoPP::SHA256> expander;
+		size_t capacity;
+		std::list<Entry> entries;
+		std::unordered_map<std::string, std::list<Entry>::iterator> cache;
+		std::string lasterror;
+	};
+}
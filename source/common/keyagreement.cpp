@@ -0,0 +1,203 @@
+#include <keyagreement.hpp>
+
+#include <cryptopp/hkdf.h>
+#include <cryptopp/sha.h>
+#include <cryptopp/oids.h>
+
+namespace cryptography
+{
+	namespace
+	{
+		static const size_t SecretLength = 32;
+		static const size_t MaxDerivedLength = 255 * CryptoPP::SHA256::DIGESTSIZE;
+
+		// a 256-bit AES key followed by its IV
+		static const size_t DirectionLength = 32 + CryptoPP::AES::BLOCKSIZE;
+	}
+
+	bool Agreement::Derive( const bytes &peerKey, const bytes &salt, const bytes &info, size_t size, bytes &derived )
+	{
+		// HKDF can't expand past 255 blocks, refuse before the output buffer is allocated
+		if( size == 0 || size > MaxDerivedLength )
+		{
+			SetLastError( "Invalid HKDF output length" );
+			return false;
+		}
+
+		try
+		{
+			CryptoPP::SecByteBlock secret;
+			if( !Agree( peerKey, secret ) )
+				return false;
+
+			bytes output( size );
+			CryptoPP::HKDF<CryptoPP::SHA256>( ).DeriveKey(
+				output.data( ),
+				output.size( ),
+				secret,
+				secret.size( ),
+				salt.data( ),
+				salt.size( ),
+				info.data( ),
+				info.size( )
+			);
+			derived.swap( output );
+			return true;
+		}
+		catch( const CryptoPP::Exception &e )
+		{
+			SetLastError( e.GetWhat( ) );
+			return false;
+		}
+	}
+
+	bool Agreement::Derive( const bytes &peerKey, const bytes &salt, const bytes &info, AES &send, AES &receive )
+	{
+		const bytes &ownKey = GetPublicKey( );
+		if( &send == &receive || peerKey == ownKey )
+		{
+			SetLastError( "the two directions need separate crypters and distinct public keys" );
+			return false;
+		}
+
+		// both sides append the keys in the same order, the lower key's direction comes first
+		const bool lower = ownKey < peerKey;
+		const bytes &first = lower ? ownKey : peerKey, &second = lower ? peerKey : ownKey;
+		bytes context( info );
+		context.insert( context.end( ), first.begin( ), first.end( ) );
+		context.insert( context.end( ), second.begin( ), second.end( ) );
+
+		bytes material;
+		if( !Derive( peerKey, salt, context, 2 * DirectionLength, material ) )
+			return false;
+
+		auto set = [this, &material]( size_t offset, AES &crypter )
+		{
+			// the IV has to be in place before the key is set
+			const bytes key( material.begin( ) + offset, material.begin( ) + offset + 32 );
+			const bytes iv( material.begin( ) + offset + 32, material.begin( ) + offset + DirectionLength );
+			if( crypter.SetSecondaryKey( iv ) && crypter.SetPrimaryKey( key ) )
+				return true;
+
+			SetLastError( crypter.GetLastError( ) );
+			return false;
+		};
+
+		return set( lower ? 0 : DirectionLength, send ) && set( lower ? DirectionLength : 0, receive );
+	}
+
+	ECDH::ECDH( ) :
+		params( CryptoPP::ASN1::secp256r1( ) )
+	{ }
+
+	std::string ECDH::AlgorithmName( ) const
+	{
+		return "ECDH(P-256)";
+	}
+
+	bool ECDH::GenerateKeyPair( )
+	{
+		try
+		{
+			CryptoPP::AutoSeededRandomPool prng;
+			const CryptoPP::Integer exponent( prng, CryptoPP::Integer::One( ), params.GetSubgroupOrder( ) - 1 );
+
+			bytes encoded( params.GetEncodedElementSize( true ) );
+			params.EncodeElement( true, p256::MultiplyBase( exponent ), encoded.data( ) );
+
+			privateKey = exponent;
+			publicKey.swap( encoded );
+			return true;
+		}
+		catch( const CryptoPP::Exception &e )
+		{
+			SetLastError( e.GetWhat( ) );
+			return false;
+		}
+	}
+
+	const bytes &ECDH::GetPublicKey( ) const
+	{
+		return publicKey;
+	}
+
+	bool ECDH::Agree( const bytes &peerKey, CryptoPP::SecByteBlock &secret )
+	{
+		if( publicKey.empty( ) )
+		{
+			SetLastError( "ECDH key pair was not generated" );
+			return false;
+		}
+
+		// cofactor 1, any affine point on the curve is in the prime order subgroup
+		CryptoPP::ECP::Point point;
+		if( !params.GetCurve( ).DecodePoint( point, peerKey.data( ), peerKey.size( ) ) ||
+			point.identity || !params.GetCurve( ).VerifyPoint( point ) )
+		{
+			SetLastError( "invalid ECDH public key" );
+			return false;
+		}
+
+		const CryptoPP::ECP::Point shared = p256::Multiply( point, privateKey );
+		secret.New( SecretLength );
+		shared.x.Encode( secret, secret.size( ) );
+		return true;
+	}
+
+	X25519::X25519( ) { }
+
+	std::string X25519::AlgorithmName( ) const
+	{
+		return "X25519";
+	}
+
+	bool X25519::GenerateKeyPair( )
+	{
+		try
+		{
+			CryptoPP::AutoSeededRandomPool prng;
+			CryptoPP::SecByteBlock priv( domain.PrivateKeyLength( ) );
+			bytes pub( domain.PublicKeyLength( ) );
+			domain.GenerateKeyPair( prng, priv, pub.data( ) );
+
+			privateKey.swap( priv );
+			publicKey.swap( pub );
+			return true;
+		}
+		catch( const CryptoPP::Exception &e )
+		{
+			SetLastError( e.GetWhat( ) );
+			return false;
+		}
+	}
+
+	const bytes &X25519::GetPublicKey( ) const
+	{
+		return publicKey;
+	}
+
+	bool X25519::Agree( const bytes &peerKey, CryptoPP::SecByteBlock &secret )
+	{
+		if( publicKey.empty( ) )
+		{
+			SetLastError( "X25519 key pair was not generated" );
+			return false;
+		}
+
+		if( peerKey.size( ) != domain.PublicKeyLength( ) )
+		{
+			SetLastError( "invalid X25519 public key" );
+			return false;
+		}
+
+		// small order points would give an all-zero secret, Agree rejects them
+		secret.New( domain.AgreedValueLength( ) );
+		if( !domain.Agree( secret, privateKey, peerKey.data( ), true ) )
+		{
+			SetLastError( "invalid X25519 public key" );
+			return false;
+		}
+
+		return true;
+	}
+}
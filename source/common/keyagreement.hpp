@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cryptography.hpp>
+#include <cryptopp/xed25519.h>
+
+namespace cryptography
+{
+	// Ephemeral Diffie-Hellman key agreement. The raw shared secret never leaves this class,
+	// every key is derived from it with HKDF-SHA256 using the caller's salt and info.
+	class Agreement
+	{
+	public:
+		virtual ~Agreement( ) { }
+
+		virtual std::string AlgorithmName( ) const = 0;
+
+		// Replaces the key pair with a freshly generated one.
+		virtual bool GenerateKeyPair( ) = 0;
+
+		virtual const bytes &GetPublicKey( ) const = 0;
+
+		bool Derive( const bytes &peerKey, const bytes &salt, const bytes &info, size_t size, bytes &derived );
+
+		// Sets a 256-bit key and an IV derived from the agreement on a crypter for each direction.
+		// The two public keys are ordered into the HKDF info, so the peer's receive crypter
+		// matches this side's send crypter and the two directions never share a key stream.
+		bool Derive( const bytes &peerKey, const bytes &salt, const bytes &info, AES &send, AES &receive );
+
+		inline const std::string &GetLastError( ) const
+		{
+			return lasterror;
+		}
+
+	protected:
+		// Computes the shared secret with the peer's public key, which is validated first.
+		virtual bool Agree( const bytes &peerKey, CryptoPP::SecByteBlock &secret ) = 0;
+
+		inline void SetLastError( const std::string &err )
+		{
+			lasterror = err;
+		}
+
+	private:
+		std::string lasterror;
+	};
+
+	// ECDH over secp256r1, public keys are uncompressed points.
+	class ECDH : public Agreement
+	{
+	public:
+		ECDH( );
+
+		std::string AlgorithmName( ) const;
+
+		bool GenerateKeyPair( );
+
+		const bytes &GetPublicKey( ) const;
+
+	protected:
+		bool Agree( const bytes &peerKey, CryptoPP::SecByteBlock &secret );
+
+	private:
+		CryptoPP::DL_GroupParameters_EC<CryptoPP::ECP> params;
+		CryptoPP::Integer privateKey;
+		bytes publicKey;
+	};
+
+	class X25519 : public Agreement
+	{
+	public:
+		X25519( );
+
+		std::string AlgorithmName( ) const;
+
+		bool GenerateKeyPair( );
+
+		const bytes &GetPublicKey( ) const;
+
+	protected:
+		bool Agree( const bytes &peerKey, CryptoPP::SecByteBlock &secret );
+
+	private:
+		CryptoPP::x25519 domain;
+		CryptoPP::SecByteBlock privateKey;
+		bytes publicKey;
+	};
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#if !defined __SIZEOF_INT128__ && defined _MSC_VER && defined _M_X64
+
+#include <intrin.h>
+
+#endif
+
+namespace cryptography
+{
+	// Word type and carry primitives shared by the fixed-width multiprecision code.
+
+#if defined __SIZEOF_INT128__ || ( defined _MSC_VER && defined _M_X64 )
+
+	typedef uint64_t Limb;
+
+#else
+
+	typedef uint32_t Limb;
+
+#endif
+
+	static const size_t LimbBits = sizeof( Limb ) * 8;
+
+	// lo( a * b + c + carry ), carry = hi( a * b + c + carry )
+	inline Limb MultiplyAdd( Limb a, Limb b, Limb c, Limb &carry )
+	{
+
+#if defined __SIZEOF_INT128__
+
+		unsigned __int128 t = static_cast<unsigned __int128>( a ) * b + c + carry;
+		carry = static_cast<Limb>( t >> LimbBits );
+		return static_cast<Limb>( t );
+
+#elif defined _MSC_VER && defined _M_X64
+
+		Limb hi;
+		Limb lo = _umul128( a, b, &hi );
+		lo += c;
+		hi += lo < c;
+		lo += carry;
+		hi += lo < carry;
+		carry = hi;
+		return lo;
+
+#else
+
+		uint64_t t = static_cast<uint64_t>( a ) * b + c + carry;
+		carry = static_cast<Limb>( t >> LimbBits );
+		return static_cast<Limb>( t );
+
+#endif
+
+	}
+
+	inline Limb AddCarry( Limb a, Limb b, Limb &carry )
+	{
+		Limb t = a + carry;
+		Limb c = t < carry;
+		Limb r = t + b;
+		carry = c | ( r < b );
+		return r;
+	}
+
+	inline Limb SubBorrow( Limb a, Limb b, Limb &borrow )
+	{
+		Limb t = a - b;
+		Limb c = a < b;
+		Limb r = t - borrow;
+		borrow = c | ( t < borrow );
+		return r;
+	}
+}
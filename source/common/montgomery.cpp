@@ -0,0 +1,307 @@
+#include <montgomery.hpp>
+
+#include <cryptopp/cpu.h>
+
+#if defined __x86_64__ && ( defined __GNUC__ || defined __clang__ )
+
+#define CRYPTOGRAPHY_MONTGOMERY_ADX
+
+#endif
+
+namespace cryptography
+{
+	namespace
+	{
+		static const size_t WindowBits = 5;
+		static const size_t WindowSize = 1 << WindowBits;
+
+		typedef Limb ( *Row )( Limb *t, const Limb *a, Limb b, size_t size );
+
+		// t[0 .. size) += a * b, returns the limb carried out of the row
+		inline Limb MultiplyAddRow( Limb *t, const Limb *a, Limb b, size_t size )
+		{
+			Limb carry = 0;
+			for( size_t j = 0; j < size; ++j )
+				t[j] = MultiplyAdd( a[j], b, t[j], carry );
+
+			return carry;
+		}
+
+#if defined CRYPTOGRAPHY_MONTGOMERY_ADX
+
+		// Same row with MULX, adding the low halves on the ADCX (carry flag) chain and the high halves
+		// of the previous column on the ADOX (overflow flag) chain, four limbs per iteration.
+		// Compilers spill the flags when given the intrinsics, so this one is written out by hand.
+		inline Limb MultiplyAddRowADX( Limb *t, const Limb *a, Limb b, size_t size )
+		{
+			Limb carry;
+			size_t blocks = size / 4;
+			__asm__ __volatile__(
+				"xorl %%r8d, %%r8d\n\t"
+				"jrcxz 2f\n"
+				"1:\n\t"
+				"mulxq 0(%[a]), %%r9, %%r10\n\t"
+				"adcxq 0(%[t]), %%r9\n\t"
+				"adoxq %%r8, %%r9\n\t"
+				"movq %%r9, 0(%[t])\n\t"
+				"mulxq 8(%[a]), %%r9, %%r8\n\t"
+				"adcxq 8(%[t]), %%r9\n\t"
+				"adoxq %%r10, %%r9\n\t"
+				"movq %%r9, 8(%[t])\n\t"
+				"mulxq 16(%[a]), %%r9, %%r10\n\t"
+				"adcxq 16(%[t]), %%r9\n\t"
+				"adoxq %%r8, %%r9\n\t"
+				"movq %%r9, 16(%[t])\n\t"
+				"mulxq 24(%[a]), %%r9, %%r8\n\t"
+				"adcxq 24(%[t]), %%r9\n\t"
+				"adoxq %%r10, %%r9\n\t"
+				"movq %%r9, 24(%[t])\n\t"
+				"leaq 32(%[a]), %[a]\n\t"
+				"leaq 32(%[t]), %[t]\n\t"
+				"leaq -1(%%rcx), %%rcx\n\t"
+				"jrcxz 2f\n\t"
+				"jmp 1b\n"
+				"2:\n\t"
+				"movq %[tail], %%rcx\n\t"
+				"jrcxz 4f\n"
+				"3:\n\t"
+				"mulxq 0(%[a]), %%r9, %%r10\n\t"
+				"adcxq 0(%[t]), %%r9\n\t"
+				"adoxq %%r8, %%r9\n\t"
+				"movq %%r9, 0(%[t])\n\t"
+				"movq %%r10, %%r8\n\t"
+				"leaq 8(%[a]), %[a]\n\t"
+				"leaq 8(%[t]), %[t]\n\t"
+				"leaq -1(%%rcx), %%rcx\n\t"
+				"jrcxz 4f\n\t"
+				"jmp 3b\n"
+				"4:\n\t"
+				"movl $0, %%r9d\n\t"
+				"adcxq %%r9, %%r8\n\t"
+				"adoxq %%r9, %%r8\n\t"
+				"movq %%r8, %[carry]"
+				: [carry] "=r" ( carry ), [t] "+r" ( t ), [a] "+r" ( a ), "+c" ( blocks )
+				: "d" ( b ), [tail] "r" ( size % 4 )
+				: "r8", "r9", "r10", "cc", "memory"
+			);
+			return carry;
+		}
+
+		bool DetectADX( )
+		{
+			// Crypto++ never sets HasADX( ) and has no BMI2 query, so read leaf 7 directly
+			CryptoPP::word32 info[4];
+			if( !CryptoPP::CpuId( 0, 0, info ) || info[0] < 7 || !CryptoPP::CpuId( 7, 0, info ) )
+				return false;
+
+			const CryptoPP::word32 bmi2 = 1u << 8, adx = 1u << 19;
+			return ( info[1] & bmi2 ) != 0 && ( info[1] & adx ) != 0;
+		}
+
+#endif
+
+		// r = t - n if t >= n, else t, where t has size + 1 limbs and t < 2n
+		void Subtract( Limb *r, const Limb *t, const Limb *n, size_t size )
+		{
+			Limb borrow = 0;
+			for( size_t j = 0; j < size; ++j )
+				r[j] = SubBorrow( t[j], n[j], borrow );
+
+			SubBorrow( t[size], 0, borrow );
+
+			const Limb mask = 0 - borrow;
+			for( size_t j = 0; j < size; ++j )
+				r[j] = ( t[j] & mask ) | ( r[j] & ~mask );
+		}
+
+		// Montgomery reduction of the 2 * size limb product in t, r = t / 2^(w * size) mod n
+		template<Row row>
+		void Reduce( Limb *r, Limb *t, const Limb *n, Limb n0, size_t size )
+		{
+			Limb carry = 0;
+			for( size_t i = 0; i < size; ++i )
+			{
+				const Limb m = t[i] * n0;
+				t[i + size] = AddCarry( t[i + size], row( t + i, n, m, size ), carry );
+			}
+
+			t[2 * size] = carry;
+			Subtract( r, t + size, n, size );
+		}
+
+		// Operand scanning, the full product is accumulated one row per limb of b
+		template<Row row>
+		void Multiply( Limb *r, const Limb *a, const Limb *b, const Limb *n, Limb n0, size_t size, Limb *t )
+		{
+			for( size_t j = 0; j < 2 * size + 1; ++j )
+				t[j] = 0;
+
+			for( size_t i = 0; i < size; ++i )
+				t[i + size] = row( t + i, a, b[i], size );
+
+			Reduce<row>( r, t, n, n0, size );
+		}
+
+		// Each cross product a[i] * a[j], i < j, is computed once, doubled, then the squares added
+		template<Row row>
+		void Square( Limb *r, const Limb *a, const Limb *n, Limb n0, size_t size, Limb *t )
+		{
+			for( size_t j = 0; j < 2 * size + 1; ++j )
+				t[j] = 0;
+
+			for( size_t i = 0; i + 1 < size; ++i )
+				t[i + size] = row( t + 2 * i + 1, a + i + 1, a[i], size - i - 1 );
+
+			Limb shifted = 0, carry = 0;
+			for( size_t i = 0; i < size; ++i )
+			{
+				Limb hi = 0;
+				const Limb lo = MultiplyAdd( a[i], a[i], 0, hi );
+				const Limb t0 = t[2 * i], t1 = t[2 * i + 1];
+				t[2 * i] = AddCarry( ( t0 << 1 ) | shifted, lo, carry );
+				t[2 * i + 1] = AddCarry( ( t1 << 1 ) | ( t0 >> ( LimbBits - 1 ) ), hi, carry );
+				shifted = t1 >> ( LimbBits - 1 );
+			}
+
+			Reduce<row>( r, t, n, n0, size );
+		}
+
+		// copies table[index] into r without an index-dependent memory access pattern
+		void Select( Limb *r, const Limb *table, size_t size, size_t index )
+		{
+			for( size_t j = 0; j < size; ++j )
+				r[j] = 0;
+
+			for( size_t i = 0; i < WindowSize; ++i )
+			{
+				const Limb mask = 0 - static_cast<Limb>( i == index );
+				const Limb *entry = table + i * size;
+				for( size_t j = 0; j < size; ++j )
+					r[j] |= entry[j] & mask;
+			}
+		}
+	}
+
+	struct Montgomery::Kernel
+	{
+		void ( *multiply )( Limb *r, const Limb *a, const Limb *b, const Limb *n, Limb n0, size_t size, Limb *t );
+		void ( *square )( Limb *r, const Limb *a, const Limb *n, Limb n0, size_t size, Limb *t );
+	};
+
+	const Montgomery::Kernel *Montgomery::SelectKernel( )
+	{
+		static const Kernel portable = { Multiply<MultiplyAddRow>, Square<MultiplyAddRow> };
+
+#if defined CRYPTOGRAPHY_MONTGOMERY_ADX
+
+		static const Kernel adx = { Multiply<MultiplyAddRowADX>, Square<MultiplyAddRowADX> };
+		if( HasFastKernel( ) )
+			return &adx;
+
+#endif
+
+		return &portable;
+	}
+
+	Montgomery::Montgomery( const CryptoPP::Integer &mod ) :
+		modulus( mod ),
+		size( ( mod.BitCount( ) + LimbBits - 1 ) / LimbBits ),
+		n0( 0 ),
+		kernel( SelectKernel( ) )
+	{
+		if( modulus.IsNegative( ) || modulus.IsEven( ) || modulus <= CryptoPP::Integer::One( ) )
+			throw CryptoPP::InvalidArgument( "Montgomery: modulus must be odd and greater than one" );
+
+		n.New( size );
+		rr.New( size );
+		one.New( size );
+		Load( n, modulus );
+		Load( rr, CryptoPP::Integer::Power2( 2 * LimbBits * size ) % modulus );
+		Load( one, CryptoPP::Integer::Power2( LimbBits * size ) % modulus );
+
+		// Newton iteration for n^-1 mod 2^w, each step doubles the correct low bits (n * n = 1 mod 8)
+		Limb inverse = n[0];
+		for( size_t bits = 3; bits < LimbBits; bits *= 2 )
+			inverse *= 2 - n[0] * inverse;
+
+		n0 = 0 - inverse;
+	}
+
+	CryptoPP::Integer Montgomery::Exponentiate( const CryptoPP::Integer &base, const CryptoPP::Integer &exponent ) const
+	{
+		if( exponent.IsNegative( ) )
+			throw CryptoPP::InvalidArgument( "Montgomery: exponent must not be negative" );
+
+		CryptoPP::SecBlock<Limb> table( WindowSize * size ), acc( size ), entry( size ), scratch( 2 * size + 1 );
+
+		Load( entry, base % modulus );
+		std::copy( one.begin( ), one.end( ), table.begin( ) );
+		kernel->multiply( table + size, entry, rr, n, n0, size, scratch );
+		for( size_t i = 2; i < WindowSize; ++i )
+			kernel->multiply( table + i * size, table + ( i - 1 ) * size, table + size, n, n0, size, scratch );
+
+		std::copy( one.begin( ), one.end( ), acc.begin( ) );
+
+		const size_t windows = ( exponent.BitCount( ) + WindowBits - 1 ) / WindowBits;
+		for( size_t w = windows; w > 0; --w )
+		{
+			for( size_t k = 0; k < WindowBits; ++k )
+				kernel->square( acc, acc, n, n0, size, scratch );
+
+			Select( entry, table, size, static_cast<size_t>( exponent.GetBits( ( w - 1 ) * WindowBits, WindowBits ) ) );
+			kernel->multiply( acc, acc, entry, n, n0, size, scratch );
+		}
+
+		// leave Montgomery form by multiplying with a plain one
+		std::fill( entry.begin( ), entry.end( ), 0 );
+		entry[0] = 1;
+		kernel->multiply( acc, acc, entry, n, n0, size, scratch );
+		return Store( acc );
+	}
+
+	bool Montgomery::HasFastKernel( )
+	{
+
+#if defined CRYPTOGRAPHY_MONTGOMERY_ADX
+
+		static const bool adx = DetectADX( );
+		return adx;
+
+#else
+
+		return false;
+
+#endif
+
+	}
+
+	bool Montgomery::IsFaster( const CryptoPP::Integer &modulus )
+	{
+		const size_t limbs = ( modulus.BitCount( ) + LimbBits - 1 ) / LimbBits;
+		return HasFastKernel( ) && ( limbs & ( limbs - 1 ) ) != 0;
+	}
+
+	void Montgomery::Load( Limb *r, const CryptoPP::Integer &value ) const
+	{
+		CryptoPP::SecByteBlock bytes( size * sizeof( Limb ) );
+		value.Encode( bytes, bytes.size( ) );
+		for( size_t i = 0; i < size; ++i )
+		{
+			Limb limb = 0;
+			for( size_t k = 0; k < sizeof( Limb ); ++k )
+				limb |= static_cast<Limb>( bytes[bytes.size( ) - 1 - i * sizeof( Limb ) - k] ) << ( k * 8 );
+
+			r[i] = limb;
+		}
+	}
+
+	CryptoPP::Integer Montgomery::Store( const Limb *a ) const
+	{
+		CryptoPP::SecByteBlock bytes( size * sizeof( Limb ) );
+		for( size_t i = 0; i < size; ++i )
+			for( size_t k = 0; k < sizeof( Limb ); ++k )
+				bytes[bytes.size( ) - 1 - i * sizeof( Limb ) - k] = static_cast<CryptoPP::byte>( a[i] >> ( k * 8 ) );
+
+		return CryptoPP::Integer( bytes, bytes.size( ) );
+	}
+}
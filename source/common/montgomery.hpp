@@ -0,0 +1,51 @@
+#pragma once
+
+#include <limb.hpp>
+#include <cryptopp/integer.h>
+#include <cryptopp/secblock.h>
+
+namespace cryptography
+{
+	// Montgomery arithmetic modulo a fixed odd modulus, used for the RSA private key halves.
+	// Multiplication runs on a MULX/ADX kernel when the processor has one, selected at runtime,
+	// and exponentiation uses a fixed 5-bit window with constant-time table lookups.
+	class Montgomery
+	{
+	public:
+		explicit Montgomery( const CryptoPP::Integer &modulus );
+
+		const CryptoPP::Integer &GetModulus( ) const
+		{
+			return modulus;
+		}
+
+		// base ^ exponent mod modulus, safe to call from several threads at once.
+		CryptoPP::Integer Exponentiate( const CryptoPP::Integer &base, const CryptoPP::Integer &exponent ) const;
+
+		// Whether this processor and build can use the MULX/ADX kernel.
+		static bool HasFastKernel( );
+
+		// Whether Exponentiate beats Integer's a_exp_b_mod_c for this modulus. Integer pads
+		// operands to a power of two words and its Comba multipliers win at those sizes, the
+		// MULX/ADX kernel only wins when the limb count isn't a power of two (1536-bit CRT
+		// halves of 3072-bit keys, for example).
+		static bool IsFaster( const CryptoPP::Integer &modulus );
+
+	private:
+		void Load( Limb *r, const CryptoPP::Integer &value ) const;
+
+		CryptoPP::Integer Store( const Limb *a ) const;
+
+		struct Kernel;
+
+		static const Kernel *SelectKernel( );
+
+		CryptoPP::Integer modulus;
+		size_t size;
+		Limb n0;
+		const Kernel *kernel;
+		CryptoPP::SecBlock<Limb> n;
+		CryptoPP::SecBlock<Limb> rr;
+		CryptoPP::SecBlock<Limb> one;
+	};
+}
@@ -0,0 +1,107 @@
+#include <multihash.hpp>
+#include <threadpool.hpp>
+
+namespace cryptography
+{
+	namespace
+	{
+		// small enough for every hash to find the slice in L1
+		static const size_t SliceSize = 16 * 1024;
+
+		// from here on a worker per hash beats the cache friendly single thread
+		static const size_t ParallelThreshold = 1024 * 1024;
+	}
+
+	MultiHash::MultiHash( const MultiHash &other )
+	{
+		hashes.reserve( other.hashes.size( ) );
+		for( const std::unique_ptr<CryptoPP::HashTransformation> &hash : other.hashes )
+			hashes.emplace_back( static_cast<CryptoPP::HashTransformation *>( hash->Clone( ) ) );
+	}
+
+	void MultiHash::Add( CryptoPP::HashTransformation *hash )
+	{
+		hashes.emplace_back( hash );
+	}
+
+	std::string MultiHash::AlgorithmName( ) const
+	{
+		std::string name = "MultiHash(";
+		for( size_t i = 0; i < hashes.size( ); ++i )
+		{
+			if( i != 0 )
+				name += ", ";
+
+			name += hashes[i]->AlgorithmName( );
+		}
+
+		return name + ")";
+	}
+
+	unsigned int MultiHash::DigestSize( ) const
+	{
+		unsigned int size = 0;
+		for( const std::unique_ptr<CryptoPP::HashTransformation> &hash : hashes )
+			size += hash->DigestSize( );
+
+		return size;
+	}
+
+	unsigned int MultiHash::OptimalBlockSize( ) const
+	{
+		return SliceSize;
+	}
+
+	void MultiHash::Update( const CryptoPP::byte *input, size_t length )
+	{
+		if( length >= ParallelThreshold && hashes.size( ) > 1 && ThreadPool::Instance( ).Size( ) != 0 )
+		{
+			ThreadPool::Instance( ).ParallelFor( hashes.size( ), [this, input, length]( size_t begin, size_t end )
+			{
+				for( size_t i = begin; i < end; ++i )
+					hashes[i]->Update( input, length );
+			} );
+			return;
+		}
+
+		for( size_t offset = 0; offset < length; offset += SliceSize )
+		{
+			const size_t slice = std::min( SliceSize, length - offset );
+			for( const std::unique_ptr<CryptoPP::HashTransformation> &hash : hashes )
+				hash->Update( input + offset, slice );
+		}
+	}
+
+	void MultiHash::TruncatedFinal( CryptoPP::byte *digest, size_t size )
+	{
+		ThrowIfInvalidTruncatedSize( size );
+
+		std::vector<bytes> digests;
+		Final( digests );
+
+		for( const bytes &single : digests )
+		{
+			const size_t taken = std::min( size, single.size( ) );
+			digest = std::copy( single.begin( ), single.begin( ) + taken, digest );
+			size -= taken;
+		}
+	}
+
+	void MultiHash::Final( std::vector<bytes> &digests )
+	{
+		std::vector<bytes> results( hashes.size( ) );
+		for( size_t i = 0; i < hashes.size( ); ++i )
+		{
+			results[i].resize( hashes[i]->DigestSize( ) );
+			hashes[i]->Final( results[i].data( ) );
+		}
+
+		digests.swap( results );
+	}
+
+	void MultiHash::Restart( )
+	{
+		for( const std::unique_ptr<CryptoPP::HashTransformation> &hash : hashes )
+			hash->Restart( );
+	}
+}
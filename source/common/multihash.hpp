@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cryptography.hpp>
+
+namespace cryptography
+{
+	// Feeds the same input to several hashes in one pass. Small updates go through every hash a
+	// slice at a time so the data is still in cache for the next one; large updates give every
+	// hash its own pool worker. The digest is the concatenation of the individual digests in the
+	// order the hashes were added, Final( digests ) returns them separately.
+	class MultiHash : public CryptoPP::HashTransformation
+	{
+	public:
+		MultiHash( ) { }
+
+		MultiHash( const MultiHash &other );
+
+		// Takes ownership of hash.
+		void Add( CryptoPP::HashTransformation *hash );
+
+		size_t Count( ) const
+		{
+			return hashes.size( );
+		}
+
+		std::string AlgorithmName( ) const;
+
+		unsigned int DigestSize( ) const;
+
+		unsigned int OptimalBlockSize( ) const;
+
+		void Update( const CryptoPP::byte *input, size_t length );
+
+		void TruncatedFinal( CryptoPP::byte *digest, size_t size );
+
+		using CryptoPP::HashTransformation::Final;
+
+		void Final( std::vector<bytes> &digests );
+
+		void Restart( );
+
+		MultiHash *Clone( ) const
+		{
+			return new MultiHash( *this );
+		}
+
+	private:
+		MultiHash &operator=( const MultiHash & );
+
+		std::vector< std::unique_ptr<CryptoPP::HashTransformation> > hashes;
+	};
+}
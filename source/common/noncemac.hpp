@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cryptopp/cryptlib.h>
+
+namespace cryptography
+{
+	// Wraps a MAC that needs a unique nonce per message (Poly1305, VMAC). Two tags under the same
+	// key and nonce let an attacker forge tags, so after every Final the object refuses to
+	// produce another tag until Resynchronize sets a new nonce. Cloning is refused for the same
+	// reason, a clone would share the nonce.
+	template<typename MAC>
+	class NonceMAC : public MAC
+	{
+	public:
+		NonceMAC( ) :
+			fresh( false )
+		{ }
+
+		void Resynchronize( const CryptoPP::byte *nonce, int length = -1 )
+		{
+			// Poly1305 only asserts the length and reads a whole block
+			this->ThrowIfInvalidIVLength( length );
+			MAC::Resynchronize( nonce, length );
+			fresh = true;
+		}
+
+		void TruncatedFinal( CryptoPP::byte *mac, size_t size )
+		{
+			if( !fresh )
+			{
+				// the refused message is dropped like a finished one would be
+				this->Restart( );
+				throw CryptoPP::Exception(
+					CryptoPP::Exception::OTHER_ERROR,
+					this->AlgorithmName( ) + ": nonce was already used, call Resynchronize with a new one"
+				);
+			}
+
+			MAC::TruncatedFinal( mac, size );
+			fresh = false;
+		}
+
+		CryptoPP::Clonable *Clone( ) const
+		{
+			throw CryptoPP::NotImplemented( this->AlgorithmName( ) + ": cloning would reuse the nonce" );
+		}
+
+	protected:
+		void UncheckedSetKey( const CryptoPP::byte *key, unsigned int length, const CryptoPP::NameValuePairs &params )
+		{
+			// a nonce passed along with the key comes back through Resynchronize
+			fresh = false;
+			MAC::UncheckedSetKey( key, length, params );
+		}
+
+	private:
+		bool fresh;
+	};
+}
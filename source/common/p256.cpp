@@ -0,0 +1,466 @@
+#include <p256.hpp>
+
+#include <cryptopp/eccrypto.h>
+#include <cryptopp/oids.h>
+#include <cryptopp/secblock.h>
+
+namespace cryptography
+{
+	namespace p256
+	{
+		namespace
+		{
+			struct Element
+			{
+				Limb v[Limbs];
+			};
+
+#if defined __SIZEOF_INT128__ || ( defined _MSC_VER && defined _M_X64 )
+
+			const Element P = { {
+				0xFFFFFFFFFFFFFFFFu, 0x00000000FFFFFFFFu, 0x0000000000000000u, 0xFFFFFFFF00000001u
+			} };
+
+#else
+
+			const Element P = { {
+				0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0x00000000u,
+				0x00000000u, 0x00000000u, 0x00000001u, 0xFFFFFFFFu
+			} };
+
+#endif
+
+			struct Constants
+			{
+				Constants( );
+
+				Element one;
+				Element b;
+				CryptoPP::Integer modulus;
+				CryptoPP::Integer order;
+				CryptoPP::ECP::Point generator;
+			};
+
+			const Constants &GetConstants( )
+			{
+				static const Constants constants;
+				return constants;
+			}
+
+			void FromInteger( Element &r, const CryptoPP::Integer &value )
+			{
+				CryptoPP::FixedSizeSecBlock<CryptoPP::byte, 32> bytes;
+				value.Encode( bytes, bytes.size( ) );
+				for( size_t i = 0; i < Limbs; ++i )
+				{
+					Limb limb = 0;
+					for( size_t k = 0; k < sizeof( Limb ); ++k )
+						limb |= static_cast<Limb>( bytes[31 - i * sizeof( Limb ) - k] ) << ( k * 8 );
+
+					r.v[i] = limb;
+				}
+			}
+
+			CryptoPP::Integer ToInteger( const Element &a )
+			{
+				CryptoPP::byte bytes[32];
+				for( size_t i = 0; i < Limbs; ++i )
+					for( size_t k = 0; k < sizeof( Limb ); ++k )
+						bytes[31 - i * sizeof( Limb ) - k] = static_cast<CryptoPP::byte>( a.v[i] >> ( k * 8 ) );
+
+				return CryptoPP::Integer( bytes, sizeof( bytes ) );
+			}
+
+			// r = a * b / 2^256 mod p, p = -1 mod 2^w so the Montgomery factor is the low limb itself
+			void Multiply( Element &r, const Element &a, const Element &b )
+			{
+				const Limb *p = P.v;
+				Limb t[Limbs + 2] = { 0 };
+
+				for( size_t i = 0; i < Limbs; ++i )
+				{
+					Limb carry = 0;
+					for( size_t j = 0; j < Limbs; ++j )
+						t[j] = MultiplyAdd( a.v[j], b.v[i], t[j], carry );
+
+					Limb overflow = 0;
+					t[Limbs] = AddCarry( t[Limbs], carry, overflow );
+					t[Limbs + 1] = overflow;
+
+					Limb m = t[0];
+					carry = 0;
+					MultiplyAdd( m, p[0], t[0], carry );
+					for( size_t j = 1; j < Limbs; ++j )
+						t[j - 1] = MultiplyAdd( m, p[j], t[j], carry );
+
+					overflow = 0;
+					t[Limbs - 1] = AddCarry( t[Limbs], carry, overflow );
+					t[Limbs] = t[Limbs + 1] + overflow;
+				}
+
+				Element s;
+				Limb borrow = 0;
+				for( size_t j = 0; j < Limbs; ++j )
+					s.v[j] = SubBorrow( t[j], p[j], borrow );
+
+				SubBorrow( t[Limbs], 0, borrow );
+				Limb keep = 0 - borrow;
+				for( size_t j = 0; j < Limbs; ++j )
+					r.v[j] = ( t[j] & keep ) | ( s.v[j] & ~keep );
+			}
+
+			inline void Square( Element &r, const Element &a )
+			{
+				Multiply( r, a, a );
+			}
+
+			void Add( Element &r, const Element &a, const Element &b )
+			{
+				const Limb *p = P.v;
+
+				Element t;
+				Limb carry = 0;
+				for( size_t j = 0; j < Limbs; ++j )
+					t.v[j] = AddCarry( a.v[j], b.v[j], carry );
+
+				Element s;
+				Limb borrow = 0;
+				for( size_t j = 0; j < Limbs; ++j )
+					s.v[j] = SubBorrow( t.v[j], p[j], borrow );
+
+				SubBorrow( carry, 0, borrow );
+				Limb keep = 0 - borrow;
+				for( size_t j = 0; j < Limbs; ++j )
+					r.v[j] = ( t.v[j] & keep ) | ( s.v[j] & ~keep );
+			}
+
+			void Subtract( Element &r, const Element &a, const Element &b )
+			{
+				const Limb *p = P.v;
+
+				Limb borrow = 0;
+				for( size_t j = 0; j < Limbs; ++j )
+					r.v[j] = SubBorrow( a.v[j], b.v[j], borrow );
+
+				Limb mask = 0 - borrow;
+				Limb carry = 0;
+				for( size_t j = 0; j < Limbs; ++j )
+					r.v[j] = AddCarry( r.v[j], p[j] & mask, carry );
+			}
+
+			bool IsZero( const Element &a )
+			{
+				Limb bits = 0;
+				for( size_t j = 0; j < Limbs; ++j )
+					bits |= a.v[j];
+
+				return bits == 0;
+			}
+
+			// a^(p - 2), the exponent is public so plain square-and-multiply is fine
+			void Invert( Element &r, const Element &a )
+			{
+				const CryptoPP::Integer exponent = GetConstants( ).modulus - 2;
+
+				Element result = GetConstants( ).one;
+				for( int i = static_cast<int>( exponent.BitCount( ) ) - 1; i >= 0; --i )
+				{
+					Square( result, result );
+					if( exponent.GetBit( static_cast<size_t>( i ) ) )
+						Multiply( result, result, a );
+				}
+
+				r = result;
+			}
+
+			void ToMontgomery( Element &r, const CryptoPP::Integer &value )
+			{
+				const Constants &constants = GetConstants( );
+				FromInteger( r, ( value << 256 ) % constants.modulus );
+			}
+
+			CryptoPP::Integer FromMontgomery( const Element &a )
+			{
+				Element plain = { { 1 } };
+				Element r;
+				Multiply( r, a, plain );
+				return ToInteger( r );
+			}
+
+			inline Element &X( Point &point )
+			{
+				return *reinterpret_cast<Element *>( point.x );
+			}
+
+			inline Element &Y( Point &point )
+			{
+				return *reinterpret_cast<Element *>( point.y );
+			}
+
+			inline Element &Z( Point &point )
+			{
+				return *reinterpret_cast<Element *>( point.z );
+			}
+
+			inline const Element &X( const Point &point )
+			{
+				return *reinterpret_cast<const Element *>( point.x );
+			}
+
+			inline const Element &Y( const Point &point )
+			{
+				return *reinterpret_cast<const Element *>( point.y );
+			}
+
+			inline const Element &Z( const Point &point )
+			{
+				return *reinterpret_cast<const Element *>( point.z );
+			}
+
+			void SetIdentity( Point &r )
+			{
+				X( r ) = Element( );
+				Y( r ) = GetConstants( ).one;
+				Z( r ) = Element( );
+			}
+
+			// complete addition for a = -3, algorithm 4 of eprint 2015/1060
+			void Add( Point &r, const Point &p1, const Point &p2 )
+			{
+				const Element &b = GetConstants( ).b;
+				Element t0, t1, t2, t3, t4, x3, y3, z3;
+
+				Multiply( t0, X( p1 ), X( p2 ) );
+				Multiply( t1, Y( p1 ), Y( p2 ) );
+				Multiply( t2, Z( p1 ), Z( p2 ) );
+				Add( t3, X( p1 ), Y( p1 ) );
+				Add( t4, X( p2 ), Y( p2 ) );
+				Multiply( t3, t3, t4 );
+				Add( t4, t0, t1 );
+				Subtract( t3, t3, t4 );
+				Add( t4, Y( p1 ), Z( p1 ) );
+				Add( x3, Y( p2 ), Z( p2 ) );
+				Multiply( t4, t4, x3 );
+				Add( x3, t1, t2 );
+				Subtract( t4, t4, x3 );
+				Add( x3, X( p1 ), Z( p1 ) );
+				Add( y3, X( p2 ), Z( p2 ) );
+				Multiply( x3, x3, y3 );
+				Add( y3, t0, t2 );
+				Subtract( y3, x3, y3 );
+				Multiply( z3, b, t2 );
+				Subtract( x3, y3, z3 );
+				Add( z3, x3, x3 );
+				Add( x3, x3, z3 );
+				Subtract( z3, t1, x3 );
+				Add( x3, t1, x3 );
+				Multiply( y3, b, y3 );
+				Add( t1, t2, t2 );
+				Add( t2, t1, t2 );
+				Subtract( y3, y3, t2 );
+				Subtract( y3, y3, t0 );
+				Add( t1, y3, y3 );
+				Add( y3, t1, y3 );
+				Add( t1, t0, t0 );
+				Add( t0, t1, t0 );
+				Subtract( t0, t0, t2 );
+				Multiply( t1, t4, y3 );
+				Multiply( t2, t0, y3 );
+				Multiply( y3, x3, z3 );
+				Add( y3, y3, t2 );
+				Multiply( x3, t3, x3 );
+				Subtract( x3, x3, t1 );
+				Multiply( z3, t4, z3 );
+				Multiply( t1, t3, t0 );
+				Add( z3, z3, t1 );
+
+				X( r ) = x3;
+				Y( r ) = y3;
+				Z( r ) = z3;
+			}
+
+			// exception-free doubling for a = -3, algorithm 6 of eprint 2015/1060
+			void Double( Point &r, const Point &p1 )
+			{
+				const Element &b = GetConstants( ).b;
+				Element t0, t1, t2, t3, x3, y3, z3;
+
+				Square( t0, X( p1 ) );
+				Square( t1, Y( p1 ) );
+				Square( t2, Z( p1 ) );
+				Multiply( t3, X( p1 ), Y( p1 ) );
+				Add( t3, t3, t3 );
+				Multiply( z3, X( p1 ), Z( p1 ) );
+				Add( z3, z3, z3 );
+				Multiply( y3, b, t2 );
+				Subtract( y3, y3, z3 );
+				Add( x3, y3, y3 );
+				Add( y3, x3, y3 );
+				Subtract( x3, t1, y3 );
+				Add( y3, t1, y3 );
+				Multiply( y3, x3, y3 );
+				Multiply( x3, x3, t3 );
+				Add( t3, t2, t2 );
+				Add( t2, t2, t3 );
+				Multiply( z3, b, z3 );
+				Subtract( z3, z3, t2 );
+				Subtract( z3, z3, t0 );
+				Add( t3, z3, z3 );
+				Add( z3, z3, t3 );
+				Add( t3, t0, t0 );
+				Add( t0, t3, t0 );
+				Subtract( t0, t0, t2 );
+				Multiply( t0, t0, z3 );
+				Add( y3, y3, t0 );
+				Multiply( t0, Y( p1 ), Z( p1 ) );
+				Add( t0, t0, t0 );
+				Multiply( z3, t0, z3 );
+				Subtract( x3, x3, z3 );
+				Multiply( z3, t0, t1 );
+				Add( z3, z3, z3 );
+				Add( z3, z3, z3 );
+
+				X( r ) = x3;
+				Y( r ) = y3;
+				Z( r ) = z3;
+			}
+
+			// reads every entry so the memory access pattern doesn't depend on the index
+			void Select( Point &r, const Point ( &table )[16], Limb index )
+			{
+				SetIdentity( r );
+				for( Limb i = 0; i < 16; ++i )
+				{
+					Limb mask = 0 - static_cast<Limb>( ( ( i ^ index ) - 1 ) >> ( sizeof( Limb ) * 8 - 1 ) );
+					for( size_t j = 0; j < Limbs; ++j )
+					{
+						r.x[j] = ( r.x[j] & ~mask ) | ( table[i].x[j] & mask );
+						r.y[j] = ( r.y[j] & ~mask ) | ( table[i].y[j] & mask );
+						r.z[j] = ( r.z[j] & ~mask ) | ( table[i].z[j] & mask );
+					}
+				}
+			}
+
+			void FromPoint( Point &r, const CryptoPP::ECP::Point &point )
+			{
+				if( point.identity )
+				{
+					SetIdentity( r );
+					return;
+				}
+
+				ToMontgomery( X( r ), point.x );
+				ToMontgomery( Y( r ), point.y );
+				Z( r ) = GetConstants( ).one;
+			}
+
+			CryptoPP::ECP::Point ToPoint( const Point &point )
+			{
+				if( IsZero( Z( point ) ) )
+					return CryptoPP::ECP::Point( );
+
+				Element inverse, x, y;
+				Invert( inverse, Z( point ) );
+				Multiply( x, X( point ), inverse );
+				Multiply( y, Y( point ), inverse );
+				return CryptoPP::ECP::Point( FromMontgomery( x ), FromMontgomery( y ) );
+			}
+
+			// scalar as 64 little-endian nibbles, reduced mod n when it doesn't fit
+			void ToNibbles( CryptoPP::FixedSizeSecBlock<CryptoPP::byte, 64> &nibbles, const CryptoPP::Integer &scalar )
+			{
+				CryptoPP::FixedSizeSecBlock<CryptoPP::byte, 32> bytes;
+				if( scalar.IsNegative( ) || scalar.BitCount( ) > 256 )
+					( scalar % GetConstants( ).order ).Encode( bytes, bytes.size( ) );
+				else
+					scalar.Encode( bytes, bytes.size( ) );
+
+				for( size_t i = 0; i < 32; ++i )
+				{
+					nibbles[2 * i] = bytes[31 - i] & 0x0F;
+					nibbles[2 * i + 1] = bytes[31 - i] >> 4;
+				}
+			}
+
+			Constants::Constants( )
+			{
+				CryptoPP::DL_GroupParameters_EC<CryptoPP::ECP> params( CryptoPP::ASN1::secp256r1( ) );
+				modulus = params.GetCurve( ).GetField( ).GetModulus( );
+				order = params.GetSubgroupOrder( );
+				generator = params.GetSubgroupGenerator( );
+
+				FromInteger( one, CryptoPP::Integer::Power2( 256 ) % modulus );
+				FromInteger( b, ( params.GetCurve( ).GetB( ) << 256 ) % modulus );
+			}
+		}
+
+		Table::Table( const CryptoPP::ECP::Point &point )
+		{
+			Point base;
+			FromPoint( base, point );
+
+			for( size_t i = 0; i < 64; ++i )
+			{
+				SetIdentity( points[i][0] );
+				points[i][1] = base;
+				for( size_t j = 2; j < 16; ++j )
+					Add( points[i][j], points[i][j - 1], base );
+
+				for( size_t k = 0; k < 4; ++k )
+					Double( base, base );
+			}
+		}
+
+		CryptoPP::ECP::Point Table::Multiply( const CryptoPP::Integer &scalar ) const
+		{
+			CryptoPP::FixedSizeSecBlock<CryptoPP::byte, 64> nibbles;
+			ToNibbles( nibbles, scalar );
+
+			Point result, entry;
+			SetIdentity( result );
+			for( size_t i = 0; i < 64; ++i )
+			{
+				Select( entry, points[i], nibbles[i] );
+				Add( result, result, entry );
+			}
+
+			return ToPoint( result );
+		}
+
+		bool IsCurve( const CryptoPP::OID &curve )
+		{
+			return curve == CryptoPP::ASN1::secp256r1( );
+		}
+
+		CryptoPP::ECP::Point MultiplyBase( const CryptoPP::Integer &scalar )
+		{
+			static const Table table( GetConstants( ).generator );
+			return table.Multiply( scalar );
+		}
+
+		CryptoPP::ECP::Point Multiply( const CryptoPP::ECP::Point &point, const CryptoPP::Integer &scalar )
+		{
+			CryptoPP::FixedSizeSecBlock<CryptoPP::byte, 64> nibbles;
+			ToNibbles( nibbles, scalar );
+
+			Point table[16];
+			SetIdentity( table[0] );
+			FromPoint( table[1], point );
+			for( size_t j = 2; j < 16; ++j )
+				Add( table[j], table[j - 1], table[1] );
+
+			Point result, entry;
+			SetIdentity( result );
+			for( size_t i = 64; i-- > 0; )
+			{
+				for( size_t k = 0; k < 4; ++k )
+					Double( result, result );
+
+				Select( entry, table, nibbles[i] );
+				Add( result, result, entry );
+			}
+
+			return ToPoint( result );
+		}
+	}
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <limb.hpp>
+#include <cryptopp/ecp.h>
+#include <cryptopp/asn.h>
+
+namespace cryptography
+{
+	// Fixed-width, constant-time secp256r1 arithmetic used instead of the generic Crypto++ ECP
+	// for 256-bit keys. Field elements are kept in Montgomery form and points in projective
+	// coordinates with the complete formulas of Renes, Costello and Batina (eprint 2015/1060).
+	namespace p256
+	{
+		static const size_t Limbs = 32 / sizeof( Limb );
+
+		struct Point
+		{
+			Limb x[Limbs];
+			Limb y[Limbs];
+			Limb z[Limbs];
+		};
+
+		// Comb table of a fixed point, multiples j * 16^i * P for every 4-bit window i.
+		class Table
+		{
+		public:
+			explicit Table( const CryptoPP::ECP::Point &point );
+
+			CryptoPP::ECP::Point Multiply( const CryptoPP::Integer &scalar ) const;
+
+		private:
+			Point points[64][16];
+		};
+
+		bool IsCurve( const CryptoPP::OID &curve );
+
+		CryptoPP::ECP::Point MultiplyBase( const CryptoPP::Integer &scalar );
+
+		CryptoPP::ECP::Point Multiply( const CryptoPP::ECP::Point &point, const CryptoPP::Integer &scalar );
+
+	}
+}
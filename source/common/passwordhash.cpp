@@ -0,0 +1,489 @@
+#include <passwordhash.hpp>
+#include <threadpool.hpp>
+#include <precomputedhmac.hpp>
+
+#include <cryptopp/salsa.h>
+#include <cryptopp/sha.h>
+#include <atomic>
+#include <chrono>
+#include <limits>
+
+namespace cryptography
+{
+	namespace
+	{
+		typedef CryptoPP::SecBlock<CryptoPP::word32> Words;
+
+		struct ScryptJob
+		{
+			bytes password;
+			ScryptParameters params;
+			size_t size;
+			Words lanes;
+			std::atomic<size_t> remaining;
+			std::mutex mutex;
+			std::string error;
+			PasswordHashCallback callback;
+		};
+
+		std::string Validate( const ScryptParameters &params, size_t size )
+		{
+			if( size == 0 )
+				return "Invalid scrypt output length";
+
+			if( params.cost < 2 || ( params.cost & ( params.cost - 1 ) ) != 0 || params.cost > ( uint64_t( 1 ) << 32 ) )
+				return "scrypt cost must be a power of two between 2 and 2^32";
+
+			if( params.blockSize == 0 || params.parallelization == 0 ||
+				uint64_t( params.blockSize ) * params.parallelization >= ( uint64_t( 1 ) << 30 ) )
+				return "Invalid scrypt block size or parallelization";
+
+			if( params.cost > std::numeric_limits<size_t>::max( ) / ( 128 * uint64_t( params.blockSize ) ) )
+				return "scrypt cost and block size need too much memory";
+
+			return std::string( );
+		}
+
+		// PBKDF2-HMAC-SHA256 (RFC 8018) on the precomputed HMAC, so every iteration costs two
+		// compressions instead of four. With a pool given the derivation is abandoned, leaving
+		// garbage, once that pool starts shutting down.
+		void PBKDF2SHA256(
+			CryptoPP::byte *derived,
+			size_t size,
+			const bytes &password,
+			const CryptoPP::byte *salt,
+			size_t saltSize,
+			uint32_t iterations,
+			const ThreadPool *pool = nullptr
+		)
+		{
+			PrecomputedHMAC<CryptoPP::SHA256> hmac( password.data( ), password.size( ) );
+			CryptoPP::FixedSizeSecBlock<CryptoPP::byte, CryptoPP::SHA256::DIGESTSIZE> u, t;
+			for( CryptoPP::word32 block = 1; size != 0; ++block )
+			{
+				CryptoPP::byte index[4];
+				CryptoPP::PutWord( false, CryptoPP::BIG_ENDIAN_ORDER, index, block );
+				hmac.Update( salt, saltSize );
+				hmac.Update( index, sizeof( index ) );
+				hmac.Final( u );
+				std::copy( u.begin( ), u.end( ), t.begin( ) );
+
+				for( uint32_t i = 1; i < iterations; ++i )
+				{
+					if( pool != nullptr && ( i & 1023 ) == 0 && pool->Stopping( ) )
+						return;
+
+					hmac.Update( u, u.size( ) );
+					hmac.Final( u );
+					for( size_t k = 0; k < t.size( ); ++k )
+						t[k] ^= u[k];
+				}
+
+				const size_t length = std::min( size, t.size( ) );
+				std::copy( t.begin( ), t.begin( ) + length, derived );
+				derived += length;
+				size -= length;
+			}
+		}
+
+		// B = PBKDF2( P, S, 1, p * 128 * r ), loaded as little endian words, 32 * r per lane
+		void Expand( const bytes &password, const bytes &salt, const ScryptParameters &params, Words &lanes )
+		{
+			CryptoPP::SecByteBlock block( 128 * size_t( params.blockSize ) * params.parallelization );
+			PBKDF2SHA256( block, block.size( ), password, salt.data( ), salt.size( ), 1 );
+
+			lanes.New( block.size( ) / 4 );
+			for( size_t i = 0; i < lanes.size( ); ++i )
+				lanes[i] = CryptoPP::GetWord<CryptoPP::word32>( false, CryptoPP::LITTLE_ENDIAN_ORDER, block + 4 * i );
+		}
+
+		void Finish( const bytes &password, const Words &lanes, size_t size, bytes &derived )
+		{
+			CryptoPP::SecByteBlock block( lanes.size( ) * 4 );
+			for( size_t i = 0; i < lanes.size( ); ++i )
+				CryptoPP::PutWord( false, CryptoPP::LITTLE_ENDIAN_ORDER, block + 4 * i, lanes[i] );
+
+			bytes output( size );
+			PBKDF2SHA256( output.data( ), size, password, block, block.size( ), 1 );
+			derived.swap( output );
+		}
+
+		// out = BlockMix( in ), Salsa20/8 chained over the 2 * r 64-byte blocks, even outputs
+		// going to the first half and odd outputs to the second
+		void BlockMix( const CryptoPP::word32 *in, CryptoPP::word32 *out, size_t r )
+		{
+			CryptoPP::word32 x[16];
+			std::copy( in + ( 2 * r - 1 ) * 16, in + 2 * r * 16, x );
+			for( size_t i = 0; i < 2 * r; ++i )
+			{
+				for( size_t k = 0; k < 16; ++k )
+					x[k] ^= in[i * 16 + k];
+
+				CryptoPP::Salsa20_Core( x, 8 );
+				std::copy( x, x + 16, out + ( i / 2 + ( i % 2 ) * r ) * 16 );
+			}
+		}
+
+		// ROMix of one lane in place. With a pool given the lane is abandoned, leaving garbage,
+		// once that pool starts shutting down.
+		void Mix( CryptoPP::word32 *lane, size_t r, uint64_t cost, const ThreadPool *pool = nullptr )
+		{
+			const size_t words = 32 * r;
+			Words v( static_cast<size_t>( cost ) * words ), x( words ), t( words );
+
+			std::copy( lane, lane + words, v.begin( ) );
+			for( uint64_t i = 0; i + 1 < cost; ++i )
+			{
+				if( pool != nullptr && ( i & 1023 ) == 0 && pool->Stopping( ) )
+					return;
+
+				BlockMix( v + i * words, v + ( i + 1 ) * words, r );
+			}
+
+			BlockMix( v + ( cost - 1 ) * words, x, r );
+
+			// cost is at most 2^32, the low word of the last block is enough to integerify
+			const CryptoPP::word32 mask = static_cast<CryptoPP::word32>( cost - 1 );
+			for( uint64_t i = 0; i < cost; ++i )
+			{
+				if( pool != nullptr && ( i & 1023 ) == 0 && pool->Stopping( ) )
+					return;
+
+				const CryptoPP::word32 *entry = v + ( x[( 2 * r - 1 ) * 16] & mask ) * words;
+				for( size_t k = 0; k < words; ++k )
+					t[k] = x[k] ^ entry[k];
+
+				BlockMix( t, x, r );
+			}
+
+			std::copy( x.begin( ), x.end( ), lane );
+		}
+
+		// Scrypt with its lanes split across ThreadPool::Instance, abandoned once cancel (when
+		// given) starts shutting down
+		void DeriveScrypt(
+			const bytes &password,
+			const bytes &salt,
+			const ScryptParameters &params,
+			size_t size,
+			bytes &derived,
+			const ThreadPool *cancel
+		)
+		{
+			Words lanes;
+			Expand( password, salt, params, lanes );
+
+			const size_t words = 32 * size_t( params.blockSize );
+			ThreadPool::Instance( ).ParallelFor( params.parallelization, [&]( size_t begin, size_t end )
+			{
+				for( size_t i = begin; i < end; ++i )
+					Mix( lanes + i * words, params.blockSize, params.cost, cancel );
+			} );
+
+			Finish( password, lanes, size, derived );
+		}
+
+		template<typename Function>
+		double Measure( Function function )
+		{
+			const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now( );
+			function( );
+			return std::chrono::duration<double>( std::chrono::steady_clock::now( ) - start ).count( );
+		}
+	}
+
+	bool Scrypt(
+		const bytes &password,
+		const bytes &salt,
+		const ScryptParameters &params,
+		size_t size,
+		bytes &derived,
+		std::string &error
+	)
+	{
+		error = Validate( params, size );
+		if( !error.empty( ) )
+			return false;
+
+		try
+		{
+			DeriveScrypt( password, salt, params, size, derived, nullptr );
+			return true;
+		}
+		catch( const std::exception &e )
+		{
+			error = e.what( );
+			return false;
+		}
+	}
+
+	void ScryptAsync(
+		const bytes &password,
+		const bytes &salt,
+		const ScryptParameters &params,
+		size_t size,
+		PasswordHashCallback callback
+	)
+	{
+		const std::string error = Validate( params, size );
+		if( !error.empty( ) )
+		{
+			bytes derived;
+			callback( derived, error );
+			return;
+		}
+
+		std::shared_ptr<ScryptJob> job = std::make_shared<ScryptJob>( );
+		job->password = password;
+		job->params = params;
+		job->size = size;
+		job->remaining = params.parallelization;
+		job->callback = std::move( callback );
+
+		ThreadPool &pool = ThreadPool::Background( );
+		pool.Submit( [job, salt, &pool]( )
+		{
+			bytes derived;
+			try
+			{
+				Expand( job->password, salt, job->params, job->lanes );
+			}
+			catch( const std::exception &e )
+			{
+				job->callback( derived, e.what( ) );
+				return;
+			}
+
+			// lanes never wait on each other, whichever finishes last completes the job, unless
+			// the pool is shutting down and the job is cancelled
+			const size_t words = 32 * size_t( job->params.blockSize );
+			for( size_t i = 0; i < job->params.parallelization; ++i )
+				pool.Submit( [job, i, words, &pool]( )
+				{
+					try
+					{
+						Mix( job->lanes + i * words, job->params.blockSize, job->params.cost, &pool );
+					}
+					catch( const std::exception &e )
+					{
+						std::lock_guard<std::mutex> lock( job->mutex );
+						if( job->error.empty( ) )
+							job->error = e.what( );
+					}
+
+					if( --job->remaining != 0 || pool.Stopping( ) )
+						return;
+
+					bytes result;
+					if( job->error.empty( ) )
+						try
+						{
+							Finish( job->password, job->lanes, job->size, result );
+						}
+						catch( const std::exception &e )
+						{
+							job->error = e.what( );
+						}
+
+					job->callback( result, job->error );
+				} );
+		} );
+	}
+
+	bool PBKDF2(
+		const bytes &password,
+		const bytes &salt,
+		uint32_t iterations,
+		size_t size,
+		bytes &derived,
+		std::string &error
+	)
+	{
+		if( iterations == 0 || size == 0 )
+		{
+			error = "Invalid PBKDF2 iterations or output length";
+			return false;
+		}
+
+		try
+		{
+			bytes output( size );
+			PBKDF2SHA256( output.data( ), size, password, salt.data( ), salt.size( ), iterations );
+			derived.swap( output );
+			return true;
+		}
+		catch( const std::exception &e )
+		{
+			error = e.what( );
+			return false;
+		}
+	}
+
+	void PBKDF2Async(
+		const bytes &password,
+		const bytes &salt,
+		uint32_t iterations,
+		size_t size,
+		PasswordHashCallback callback
+	)
+	{
+		if( iterations == 0 || size == 0 )
+		{
+			bytes derived;
+			callback( derived, "Invalid PBKDF2 iterations or output length" );
+			return;
+		}
+
+		ThreadPool &pool = ThreadPool::Background( );
+		pool.Submit( [password, salt, iterations, size, callback, &pool]( )
+		{
+			bytes derived;
+			std::string error;
+			try
+			{
+				bytes output( size );
+				PBKDF2SHA256( output.data( ), size, password, salt.data( ), salt.size( ), iterations, &pool );
+				derived.swap( output );
+			}
+			catch( const std::exception &e )
+			{
+				error = e.what( );
+			}
+
+			if( !pool.Stopping( ) )
+				callback( derived, error );
+		} );
+	}
+
+	namespace
+	{
+		// The calibrations below give up early, returning whatever they measured so far, once
+		// cancel (when given) starts shutting down.
+		ScryptParameters CalibrateScryptWith(
+			double seconds,
+			uint32_t blockSize,
+			uint32_t parallelization,
+			size_t maxMemory,
+			const ThreadPool *cancel
+		)
+		{
+			ScryptParameters params = { 1024, blockSize, parallelization };
+			const uint64_t laneCost = 128 * uint64_t( blockSize ) * parallelization;
+			while( params.cost > 2 && params.cost * laneCost > maxMemory )
+				params.cost /= 2;
+
+			const bytes password( 16, 'p' ), salt( 16, 's' );
+			bytes derived;
+			auto measure = [&]( )
+			{
+				return Measure( [&]( )
+				{
+					// a failed run (out of memory) still counts as measured, like the Scrypt call did
+					try
+					{
+						DeriveScrypt( password, salt, params, 32, derived, cancel );
+					}
+					catch( const std::exception & )
+					{ }
+				} );
+			};
+
+			double elapsed = measure( );
+
+			// the work doubles with the cost, so stop once the next step would overshoot
+			while( params.cost < ( uint64_t( 1 ) << 32 ) && params.cost * 2 * laneCost <= maxMemory && elapsed * 2 <= seconds )
+			{
+				if( cancel != nullptr && cancel->Stopping( ) )
+					return params;
+
+				params.cost *= 2;
+				elapsed = measure( );
+			}
+
+			while( params.cost > 2 && elapsed > seconds )
+			{
+				params.cost /= 2;
+				elapsed /= 2;
+			}
+
+			return params;
+		}
+
+		uint32_t CalibratePBKDF2With( double seconds, const ThreadPool *cancel )
+		{
+			const bytes password( 16, 'p' ), salt( 16, 's' );
+			CryptoPP::byte derived[32];
+			uint32_t iterations = 1000;
+			auto measure = [&]( )
+			{
+				return Measure( [&]( )
+				{
+					PBKDF2SHA256( derived, sizeof( derived ), password, salt.data( ), salt.size( ), iterations, cancel );
+				} );
+			};
+
+			// time enough iterations for the clock to be meaningful, then scale linearly
+			double elapsed = measure( );
+			while( elapsed < std::min( seconds, 0.05 ) && iterations < ( 1u << 30 ) )
+			{
+				if( cancel != nullptr && cancel->Stopping( ) )
+					break;
+
+				iterations *= 2;
+				elapsed = measure( );
+			}
+
+			const double estimate = iterations * seconds / std::max( elapsed, 1e-6 );
+			if( estimate < 1 )
+				return 1;
+
+			if( estimate > std::numeric_limits<uint32_t>::max( ) )
+				return std::numeric_limits<uint32_t>::max( );
+
+			return static_cast<uint32_t>( estimate );
+		}
+	}
+
+	ScryptParameters CalibrateScrypt(
+		double seconds,
+		uint32_t blockSize,
+		uint32_t parallelization,
+		size_t maxMemory
+	)
+	{
+		return CalibrateScryptWith( seconds, blockSize, parallelization, maxMemory, nullptr );
+	}
+
+	void CalibrateScryptAsync(
+		double seconds,
+		uint32_t blockSize,
+		uint32_t parallelization,
+		size_t maxMemory,
+		ScryptCalibrationCallback callback
+	)
+	{
+		ThreadPool &pool = ThreadPool::Background( );
+		pool.Submit( [seconds, blockSize, parallelization, maxMemory, callback, &pool]( )
+		{
+			const ScryptParameters params = CalibrateScryptWith( seconds, blockSize, parallelization, maxMemory, &pool );
+			if( !pool.Stopping( ) )
+				callback( params );
+		} );
+	}
+
+	uint32_t CalibratePBKDF2( double seconds )
+	{
+		return CalibratePBKDF2With( seconds, nullptr );
+	}
+
+	void CalibratePBKDF2Async( double seconds, PBKDF2CalibrationCallback callback )
+	{
+		ThreadPool &pool = ThreadPool::Background( );
+		pool.Submit( [seconds, callback, &pool]( )
+		{
+			const uint32_t iterations = CalibratePBKDF2With( seconds, &pool );
+			if( !pool.Stopping( ) )
+				callback( iterations );
+		} );
+	}
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cryptography.hpp>
+#include <functional>
+
+namespace cryptography
+{
+	struct ScryptParameters
+	{
+		uint64_t cost;
+		uint32_t blockSize;
+		uint32_t parallelization;
+	};
+
+	// Receives the derived key, or an empty key and a non-empty error. Async operations call it
+	// from a worker thread.
+	typedef std::function<void( bytes &derived, const std::string &error )> PasswordHashCallback;
+
+	// scrypt (RFC 7914). Each of the parallelization lanes runs its memory-hard mix on a
+	// different core of the thread pool.
+	bool Scrypt(
+		const bytes &password,
+		const bytes &salt,
+		const ScryptParameters &params,
+		size_t size,
+		bytes &derived,
+		std::string &error
+	);
+
+	// Same as Scrypt without blocking, every lane is a separate task on ThreadPool::Background
+	// and the last one to finish runs the final step and the callback. Shutting that pool down
+	// cancels the job without calling back.
+	void ScryptAsync(
+		const bytes &password,
+		const bytes &salt,
+		const ScryptParameters &params,
+		size_t size,
+		PasswordHashCallback callback
+	);
+
+	// PBKDF2-HMAC-SHA256.
+	bool PBKDF2(
+		const bytes &password,
+		const bytes &salt,
+		uint32_t iterations,
+		size_t size,
+		bytes &derived,
+		std::string &error
+	);
+
+	// Runs on ThreadPool::Background. Shutting that pool down abandons the iterations within
+	// about a thousand of them and skips the callback.
+	void PBKDF2Async(
+		const bytes &password,
+		const bytes &salt,
+		uint32_t iterations,
+		size_t size,
+		PasswordHashCallback callback
+	);
+
+	// Receive the calibrated parameters, called from a worker thread.
+	typedef std::function<void( const ScryptParameters &params )> ScryptCalibrationCallback;
+	typedef std::function<void( uint32_t iterations )> PBKDF2CalibrationCallback;
+
+	// Picks the largest power of two cost that hashes within seconds on this host, keeping the
+	// memory used by all lanes (128 * blockSize * cost * parallelization bytes) under maxMemory.
+	// Measuring can take up to about twice seconds.
+	ScryptParameters CalibrateScrypt(
+		double seconds,
+		uint32_t blockSize,
+		uint32_t parallelization,
+		size_t maxMemory
+	);
+
+	// Same as CalibrateScrypt on ThreadPool::Background, cancelled like ScryptAsync.
+	void CalibrateScryptAsync(
+		double seconds,
+		uint32_t blockSize,
+		uint32_t parallelization,
+		size_t maxMemory,
+		ScryptCalibrationCallback callback
+	);
+
+	// Iterations of PBKDF2-HMAC-SHA256 that take about seconds on this host.
+	uint32_t CalibratePBKDF2( double seconds );
+
+	// Same as CalibratePBKDF2 on ThreadPool::Background, cancelled like PBKDF2Async.
+	void CalibratePBKDF2Async( double seconds, PBKDF2CalibrationCallback callback );
+}
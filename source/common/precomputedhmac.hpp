@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cryptopp/cryptlib.h>
+#include <cryptopp/secblock.h>
+#include <algorithm>
+#include <climits>
+#include <string>
+
+namespace cryptography
+{
+	// HMAC that keeps the hash states left after absorbing the ipad and opad blocks, so
+	// Restart and every Final start from a copy of those midstates instead of rehashing the
+	// padded key. Clone copies the midstates and whatever has been absorbed so far.
+	template<typename Hasher>
+	class PrecomputedHMAC : public CryptoPP::MessageAuthenticationCode
+	{
+	public:
+		static std::string StaticAlgorithmName( )
+		{
+			return std::string( "HMAC(" ) + Hasher::StaticAlgorithmName( ) + ")";
+		}
+
+		PrecomputedHMAC( ) { }
+
+		PrecomputedHMAC( const CryptoPP::byte *key, size_t length )
+		{
+			SetKey( key, length );
+		}
+
+		std::string AlgorithmName( ) const
+		{
+			return StaticAlgorithmName( );
+		}
+
+		unsigned int DigestSize( ) const
+		{
+			return Hasher::DIGESTSIZE;
+		}
+
+		unsigned int OptimalBlockSize( ) const
+		{
+			return inner.OptimalBlockSize( );
+		}
+
+		size_t MinKeyLength( ) const
+		{
+			return 0;
+		}
+
+		size_t MaxKeyLength( ) const
+		{
+			return INT_MAX;
+		}
+
+		size_t DefaultKeyLength( ) const
+		{
+			return 16;
+		}
+
+		size_t GetValidKeyLength( size_t length ) const
+		{
+			return length;
+		}
+
+		IV_Requirement IVRequirement( ) const
+		{
+			return NOT_RESYNCHRONIZABLE;
+		}
+
+		void Update( const CryptoPP::byte *input, size_t length )
+		{
+			inner.Update( input, length );
+		}
+
+		void TruncatedFinal( CryptoPP::byte *mac, size_t size )
+		{
+			ThrowIfInvalidTruncatedSize( size );
+
+			CryptoPP::byte digest[Hasher::DIGESTSIZE];
+			inner.Final( digest );
+
+			Hasher outer( outerStart );
+			outer.Update( digest, sizeof( digest ) );
+			outer.TruncatedFinal( mac, size );
+
+			inner = innerStart;
+		}
+
+		void Restart( )
+		{
+			inner = innerStart;
+		}
+
+		PrecomputedHMAC *Clone( ) const
+		{
+			return new PrecomputedHMAC( *this );
+		}
+
+	protected:
+		void UncheckedSetKey( const CryptoPP::byte *key, unsigned int length, const CryptoPP::NameValuePairs & )
+		{
+			const size_t blockSize = inner.BlockSize( );
+			CryptoPP::SecByteBlock pad;
+			pad.CleanNew( blockSize );
+			if( length > blockSize )
+				Hasher( ).CalculateDigest( pad, key, length );
+			else
+				std::copy( key, key + length, pad.begin( ) );
+
+			for( size_t i = 0; i < blockSize; ++i )
+				pad[i] ^= 0x36;
+
+			innerStart = Hasher( );
+			innerStart.Update( pad, blockSize );
+
+			// 0x36 ^ 0x5c turns the ipad block into the opad block
+			for( size_t i = 0; i < blockSize; ++i )
+				pad[i] ^= 0x36 ^ 0x5c;
+
+			outerStart = Hasher( );
+			outerStart.Update( pad, blockSize );
+
+			inner = innerStart;
+		}
+
+	private:
+		Hasher innerStart;
+		Hasher outerStart;
+		Hasher inner;
+	};
+}
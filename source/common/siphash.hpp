@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cryptopp/siphash.h>
+#include <cryptopp/misc.h>
+
+namespace cryptography
+{
+	typedef CryptoPP::SipHash<2, 4> SipHash;
+
+	// Keeps the low 52 bits of the little endian output, every one of those values is exactly
+	// representable as a Lua number.
+	inline double SipHashNumber( SipHash &siphash, const CryptoPP::byte *data, size_t len )
+	{
+		CryptoPP::byte digest[SipHash::DIGESTSIZE];
+		siphash.CalculateDigest( digest, data, len );
+		const CryptoPP::word64 value = CryptoPP::GetWord<CryptoPP::word64>( false, CryptoPP::LITTLE_ENDIAN_ORDER, digest );
+		return static_cast<double>( value & ( ( CryptoPP::word64( 1 ) << 52 ) - 1 ) );
+	}
+}
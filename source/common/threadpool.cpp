@@ -0,0 +1,111 @@
+#include <threadpool.hpp>
+
+namespace cryptography
+{
+	namespace
+	{
+		thread_local const ThreadPool *workerPool = nullptr;
+	}
+
+	ThreadPool &ThreadPool::Instance( )
+	{
+		static ThreadPool pool;
+		return pool;
+	}
+
+	ThreadPool &ThreadPool::Background( )
+	{
+		static ThreadPool pool;
+		return pool;
+	}
+
+	ThreadPool::ThreadPool( ) :
+		stopping( false )
+	{ }
+
+	ThreadPool::~ThreadPool( )
+	{
+		Shutdown( );
+	}
+
+	size_t ThreadPool::Size( ) const
+	{
+		// leave a core to the thread that submits the work
+		const size_t cores = std::thread::hardware_concurrency( );
+		return cores > 2 ? cores - 1 : 1;
+	}
+
+	bool ThreadPool::IsWorkerThread( )
+	{
+		return workerPool != nullptr;
+	}
+
+	bool ThreadPool::IsOwnWorker( ) const
+	{
+		return workerPool == this;
+	}
+
+	void ThreadPool::Shutdown( )
+	{
+		std::vector<std::thread> joining;
+		std::deque< std::function<void( )> > dropped;
+
+		{
+			std::lock_guard<std::mutex> lock( mutex );
+			stopping = true;
+			joining.swap( workers );
+			dropped.swap( tasks );
+			wakeup.notify_all( );
+		}
+
+		// the dropped tasks free what they captured (and with it their callbacks) outside the lock
+		dropped.clear( );
+
+		for( std::thread &worker : joining )
+			worker.join( );
+
+		std::lock_guard<std::mutex> lock( mutex );
+		stopping = false;
+	}
+
+	void ThreadPool::Enqueue( std::function<void( )> task )
+	{
+		std::lock_guard<std::mutex> lock( mutex );
+
+		// tasks submitted from a worker during Shutdown would otherwise start workers nobody joins
+		if( stopping )
+			return;
+
+		if( workers.empty( ) )
+			for( size_t i = Size( ); i > 0; --i )
+				workers.emplace_back( &ThreadPool::Work, this );
+
+		tasks.push_back( std::move( task ) );
+		wakeup.notify_one( );
+	}
+
+	void ThreadPool::Work( )
+	{
+		workerPool = this;
+
+		std::unique_lock<std::mutex> lock( mutex );
+		while( true )
+		{
+			if( stopping )
+				break;
+
+			if( tasks.empty( ) )
+			{
+				wakeup.wait( lock );
+				continue;
+			}
+
+			std::function<void( )> task = std::move( tasks.front( ) );
+			tasks.pop_front( );
+
+			lock.unlock( );
+			task( );
+			lock.lock( );
+		}
+	}
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstddef>
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <condition_variable>
+#include <type_traits>
+
+namespace cryptography
+{
+	// Worker threads shared by every operation that splits its work off the calling thread.
+	class ThreadPool
+	{
+	public:
+		static ThreadPool &Instance( );
+
+		// Separate workers for long asynchronous jobs (key derivation), so they never queue ahead
+		// of the synchronous ParallelFor and Submit callers on Instance.
+		static ThreadPool &Background( );
+
+		// Queues a task, starting the workers on first use, and returns a future for its result.
+		// While the pool shuts down the task is dropped and the future reports a broken promise.
+		template<typename Function>
+		std::future<typename std::result_of<Function( )>::type> Submit( Function function )
+		{
+			typedef typename std::result_of<Function( )>::type Result;
+			std::shared_ptr< std::packaged_task<Result( )> > task =
+				std::make_shared< std::packaged_task<Result( )> >( std::move( function ) );
+			std::future<Result> result = task->get_future( );
+			Enqueue( [task]( ) { ( *task )( ); } );
+			return result;
+		}
+
+		// Splits [0, count) into one contiguous range per worker plus one for the calling thread and
+		// waits for function( begin, end ) to finish on all of them. The first exception thrown is
+		// rethrown afterwards. Called from one of this pool's workers, the whole range runs inline.
+		template<typename Function>
+		void ParallelFor( size_t count, Function function )
+		{
+			const size_t ranges = IsOwnWorker( ) ? 1 : std::min( count, Size( ) + 1 );
+			if( ranges <= 1 )
+			{
+				if( count != 0 )
+					function( 0, count );
+
+				return;
+			}
+
+			std::vector< std::future<void> > pending;
+			pending.reserve( ranges - 1 );
+			for( size_t range = 1; range < ranges; ++range )
+			{
+				const size_t begin = count * range / ranges, end = count * ( range + 1 ) / ranges;
+				pending.push_back( Submit( [&function, begin, end]( ) { function( begin, end ); } ) );
+			}
+
+			std::exception_ptr error;
+			try
+			{
+				function( 0, count / ranges );
+			}
+			catch( ... )
+			{
+				error = std::current_exception( );
+			}
+
+			for( std::future<void> &future : pending )
+				try
+				{
+					future.get( );
+				}
+				catch( ... )
+				{
+					if( !error )
+						error = std::current_exception( );
+				}
+
+			if( error )
+				std::rethrow_exception( error );
+		}
+
+		// Number of workers the pool runs once started.
+		size_t Size( ) const;
+
+		// Tasks must not wait on other tasks when this is true, the pool could run out of workers.
+		static bool IsWorkerThread( );
+
+		// True while Shutdown runs, long tasks should give up early and skip their completion.
+		bool Stopping( ) const
+		{
+			return stopping;
+		}
+
+		// Drops the tasks still queued, waits for the running ones and joins every worker.
+		void Shutdown( );
+
+	private:
+		ThreadPool( );
+		~ThreadPool( );
+
+		// whether the calling thread is one of this pool's workers, Background tasks can still wait
+		// on Instance since nothing there waits on Background
+		bool IsOwnWorker( ) const;
+
+		void Enqueue( std::function<void( )> task );
+
+		void Work( );
+
+		std::mutex mutex;
+		std::condition_variable wakeup;
+		std::vector<std::thread> workers;
+		std::deque< std::function<void( )> > tasks;
+		std::atomic<bool> stopping;
+	};
+}
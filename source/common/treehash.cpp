@@ -0,0 +1,130 @@
+#include <treehash.hpp>
+#include <threadpool.hpp>
+
+#include <cryptopp/misc.h>
+#include <algorithm>
+#include <string>
+
+namespace cryptography
+{
+	namespace
+	{
+		static const CryptoPP::byte LeafPrefix = 0x00;
+		static const CryptoPP::byte NodePrefix = 0x01;
+
+		void HashNode( const CryptoPP::byte *left, const CryptoPP::byte *right, CryptoPP::byte *digest )
+		{
+			CryptoPP::SHA256 sha256;
+			sha256.Update( &NodePrefix, 1 );
+			sha256.Update( left, CryptoPP::SHA256::DIGESTSIZE );
+			sha256.Update( right, CryptoPP::SHA256::DIGESTSIZE );
+			sha256.Final( digest );
+		}
+	}
+
+	const size_t TreeHash::DefaultChunkSize;
+	const size_t TreeHash::MinChunkSize;
+	const size_t TreeHash::MaxChunkSize;
+
+	TreeHash::TreeHash( size_t size ) :
+		chunkSize( size ),
+		batchSize( ThreadPool::Instance( ).Size( ) + 1 )
+	{
+		if( size < MinChunkSize || size > MaxChunkSize )
+			throw CryptoPP::InvalidArgument(
+				std::string( StaticAlgorithmName( ) ) + ": chunk size must be between " +
+				CryptoPP::IntToString( MinChunkSize ) + " and " + CryptoPP::IntToString( MaxChunkSize ) + " bytes"
+			);
+	}
+
+	void TreeHash::Update( const CryptoPP::byte *input, size_t length )
+	{
+		const size_t capacity = batchSize * chunkSize;
+		while( length != 0 )
+		{
+			// whole chunks straight from the input, no copy needed
+			if( pending.empty( ) && length >= chunkSize )
+			{
+				const size_t whole = length - length % chunkSize;
+				AddLeaves( input, whole );
+				input += whole;
+				length -= whole;
+				continue;
+			}
+
+			const size_t taken = std::min( length, capacity - pending.size( ) );
+			pending.insert( pending.end( ), input, input + taken );
+			input += taken;
+			length -= taken;
+
+			if( pending.size( ) == capacity )
+			{
+				AddLeaves( pending.data( ), pending.size( ) );
+				pending.clear( );
+			}
+		}
+	}
+
+	void TreeHash::TruncatedFinal( CryptoPP::byte *digest, size_t size )
+	{
+		ThrowIfInvalidTruncatedSize( size );
+
+		if( !pending.empty( ) )
+			AddLeaves( pending.data( ), pending.size( ) );
+
+		CryptoPP::byte root[DIGESTSIZE];
+		if( subtrees.empty( ) )
+		{
+			CryptoPP::SHA256( ).Final( root );
+		}
+		else
+		{
+			// the remaining subtrees shrink from left to right, folding them from the right
+			// splits at the largest power of two just like RFC 6962
+			std::copy( subtrees.back( ).digest, subtrees.back( ).digest + DIGESTSIZE, root );
+			for( size_t i = subtrees.size( ) - 1; i > 0; --i )
+				HashNode( subtrees[i - 1].digest, root, root );
+		}
+
+		std::copy( root, root + size, digest );
+		Restart( );
+	}
+
+	void TreeHash::Restart( )
+	{
+		pending.clear( );
+		subtrees.clear( );
+	}
+
+	void TreeHash::AddLeaves( const CryptoPP::byte *data, size_t length )
+	{
+		const size_t count = ( length + chunkSize - 1 ) / chunkSize;
+		std::vector<Subtree> leaves( count );
+		ThreadPool::Instance( ).ParallelFor( count, [this, data, length, &leaves]( size_t begin, size_t end )
+		{
+			CryptoPP::SHA256 sha256;
+			for( size_t i = begin; i < end; ++i )
+			{
+				const size_t offset = i * chunkSize;
+				sha256.Update( &LeafPrefix, 1 );
+				sha256.Update( data + offset, std::min( chunkSize, length - offset ) );
+				sha256.Final( leaves[i].digest );
+				leaves[i].leaves = 1;
+			}
+		} );
+
+		// equal sized neighbours merge like a binary counter, leaving perfect subtrees of
+		// decreasing size
+		for( const Subtree &leaf : leaves )
+		{
+			subtrees.push_back( leaf );
+			while( subtrees.size( ) >= 2 && subtrees[subtrees.size( ) - 2].leaves == subtrees.back( ).leaves )
+			{
+				Subtree &left = subtrees[subtrees.size( ) - 2];
+				HashNode( left.digest, subtrees.back( ).digest, left.digest );
+				left.leaves *= 2;
+				subtrees.pop_back( );
+			}
+		}
+	}
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cryptopp/sha.h>
+#include <cstdint>
+#include <vector>
+
+namespace cryptography
+{
+	// SHA-256 Merkle tree hash over fixed-size chunks, the Merkle Tree Hash of RFC 6962
+	// section 2.1 with every chunk as one leaf:
+	//   leaf = SHA-256( 0x00 || chunk ), node = SHA-256( 0x01 || left || right )
+	// and a tree of n > 1 leaves split after the largest power of two below n. A single chunk
+	// hashes to its leaf, empty input to SHA-256 of nothing. The chunk size is part of the
+	// result, both sides must agree on it.
+	// Up to one chunk per core is buffered and the leaves are hashed on the thread pool, so a
+	// single large input uses every core. Subtrees are merged as they complete, only the
+	// pending buffer and one digest per tree level are kept.
+	class TreeHash : public CryptoPP::HashTransformation
+	{
+	public:
+		CRYPTOPP_CONSTANT( DIGESTSIZE = CryptoPP::SHA256::DIGESTSIZE );
+
+		static const size_t DefaultChunkSize = 1024 * 1024;
+		static const size_t MinChunkSize = 1024;
+		static const size_t MaxChunkSize = 1024 * 1024 * 1024;
+
+		static const char *StaticAlgorithmName( )
+		{
+			return "TreeHash(SHA-256)";
+		}
+
+		// Throws CryptoPP::InvalidArgument when size is outside [MinChunkSize, MaxChunkSize].
+		explicit TreeHash( size_t size = DefaultChunkSize );
+
+		std::string AlgorithmName( ) const
+		{
+			return StaticAlgorithmName( );
+		}
+
+		unsigned int DigestSize( ) const
+		{
+			return DIGESTSIZE;
+		}
+
+		unsigned int OptimalBlockSize( ) const
+		{
+			return static_cast<unsigned int>( chunkSize );
+		}
+
+		size_t ChunkSize( ) const
+		{
+			return chunkSize;
+		}
+
+		void Update( const CryptoPP::byte *input, size_t length );
+
+		void TruncatedFinal( CryptoPP::byte *digest, size_t size );
+
+		void Restart( );
+
+		TreeHash *Clone( ) const
+		{
+			return new TreeHash( *this );
+		}
+
+	private:
+		struct Subtree
+		{
+			CryptoPP::byte digest[DIGESTSIZE];
+			uint64_t leaves;
+		};
+
+		// Hashes length bytes as consecutive chunks, the last one may be short.
+		void AddLeaves( const CryptoPP::byte *data, size_t length );
+
+		size_t chunkSize;
+		size_t batchSize;
+		std::vector<CryptoPP::byte> pending;
+		std::vector<Subtree> subtrees;
+	};
+}
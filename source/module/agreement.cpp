@@ -0,0 +1,305 @@
+#include <agreement.hpp>
+#include <keyagreement.hpp>
+#include <crypt.hpp>
+#include <GarrysMod/Lua/Interface.h>
+#include <cstdint>
+
+namespace agreement
+{
+
+static const char *metaname = "agreement";
+static int32_t metatype = GarrysMod::Lua::Type::NONE;
+static const char *invalid_error = "invalid agreement";
+
+inline void CheckType( GarrysMod::Lua::ILuaBase *LUA, int32_t index )
+{
+	if( !LUA->IsType( index, metatype ) )
+		LUA->TypeError( index, metaname );
+}
+
+static cryptography::Agreement *GetUserData( GarrysMod::Lua::ILuaBase *LUA, int32_t index )
+{
+	CheckType( LUA, index );
+	return LUA->GetUserType<cryptography::Agreement>( index, metatype );
+}
+
+static cryptography::Agreement *Get( GarrysMod::Lua::ILuaBase *LUA, int32_t index )
+{
+	cryptography::Agreement *agreement = GetUserData( LUA, index );
+	if( agreement == nullptr )
+		LUA->ArgError( index, invalid_error );
+
+	return agreement;
+}
+
+// optional string arguments (salt and info) default to empty
+static cryptography::bytes GetOptionalBytes( GarrysMod::Lua::ILuaBase *LUA, int32_t index )
+{
+	if( LUA->IsType( index, GarrysMod::Lua::Type::NONE ) || LUA->IsType( index, GarrysMod::Lua::Type::NIL ) )
+		return cryptography::bytes( );
+
+	LUA->CheckType( index, GarrysMod::Lua::Type::STRING );
+
+	uint32_t len = 0;
+	const uint8_t *data = reinterpret_cast<const uint8_t *>( LUA->GetString( index, &len ) );
+	return cryptography::bytes( data, data + len );
+}
+
+LUA_FUNCTION_STATIC( tostring )
+{
+
+#if defined _WIN32
+
+	LUA->PushFormattedString( "%s: %p", metaname, Get( LUA, 1 ) );
+
+#elif defined __linux || defined __APPLE__
+
+	LUA->PushFormattedString( "%s: 0x%p", metaname, Get( LUA, 1 ) );
+
+#endif
+
+	return 1;
+}
+
+LUA_FUNCTION_STATIC( eq )
+{
+	LUA->PushBool( Get( LUA, 1 ) == Get( LUA, 2 ) );
+	return 1;
+}
+
+LUA_FUNCTION_STATIC( index )
+{
+	CheckType( LUA, 1 );
+
+	LUA->PushMetaTable( metatype );
+	LUA->Push( 2 );
+	LUA->RawGet( -2 );
+	if( !LUA->IsType( -1, GarrysMod::Lua::Type::NIL ) )
+		return 1;
+
+	LUA->Pop( 2 );
+
+	LUA->GetFEnv( 1 );
+	LUA->Push( 2 );
+	LUA->RawGet( -2 );
+	return 1;
+}
+
+LUA_FUNCTION_STATIC( newindex )
+{
+	CheckType( LUA, 1 );
+
+	LUA->GetFEnv( 1 );
+	LUA->Push( 2 );
+	LUA->Push( 3 );
+	LUA->RawSet( -3 );
+	return 0;
+}
+
+LUA_FUNCTION_STATIC( gc )
+{
+	cryptography::Agreement *agreement = GetUserData( LUA, 1 );
+	if( agreement == nullptr )
+		return 0;
+
+	try
+	{
+		delete agreement;
+		LUA->SetUserType( 1, nullptr );
+		return 0;
+	}
+	catch( const CryptoPP::Exception &e )
+	{
+		LUA->PushString( e.what( ) );
+	}
+
+	return 1;
+}
+
+LUA_FUNCTION_STATIC( IsValid )
+{
+	LUA->PushBool( GetUserData( LUA, 1 ) != nullptr );
+	return 1;
+}
+
+LUA_FUNCTION_STATIC( AlgorithmName )
+{
+	LUA->PushString( Get( LUA, 1 )->AlgorithmName( ).c_str( ) );
+	return 1;
+}
+
+LUA_FUNCTION_STATIC( GenerateKeyPair )
+{
+	cryptography::Agreement *agreement = Get( LUA, 1 );
+	if( !agreement->GenerateKeyPair( ) )
+	{
+		LUA->PushNil( );
+		LUA->PushString( agreement->GetLastError( ).c_str( ) );
+		return 2;
+	}
+
+	LUA->PushBool( true );
+	return 1;
+}
+
+LUA_FUNCTION_STATIC( GetPublicKey )
+{
+	const cryptography::bytes &pubKey = Get( LUA, 1 )->GetPublicKey( );
+	LUA->PushString( reinterpret_cast<const char *>( pubKey.data( ) ), pubKey.size( ) );
+	return 1;
+}
+
+LUA_FUNCTION_STATIC( Derive )
+{
+	cryptography::Agreement *agreement = Get( LUA, 1 );
+	LUA->CheckType( 2, GarrysMod::Lua::Type::STRING );
+	const size_t size = static_cast<size_t>( LUA->CheckNumber( 3 ) );
+
+	uint32_t peerLen = 0;
+	const uint8_t *peerKey = reinterpret_cast<const uint8_t *>( LUA->GetString( 2, &peerLen ) );
+
+	cryptography::bytes derived;
+	if( !agreement->Derive(
+		cryptography::bytes( peerKey, peerKey + peerLen ),
+		GetOptionalBytes( LUA, 4 ),
+		GetOptionalBytes( LUA, 5 ),
+		size,
+		derived
+	) )
+	{
+		LUA->PushNil( );
+		LUA->PushString( agreement->GetLastError( ).c_str( ) );
+		return 2;
+	}
+
+	LUA->PushString( reinterpret_cast<const char *>( derived.data( ) ), derived.size( ) );
+	return 1;
+}
+
+// agreement:DeriveCrypters( send, receive, peerKey[, salt[, info]] ), keys two AES crypters, the
+// peer's receive crypter decrypts what our send crypter encrypts and the other way around
+LUA_FUNCTION_STATIC( DeriveCrypters )
+{
+	cryptography::Agreement *agreement = Get( LUA, 1 );
+	cryptography::AES *send = dynamic_cast<cryptography::AES *>( crypt::Get( LUA, 2 ) );
+	if( send == nullptr )
+		LUA->ArgError( 2, "AES crypter expected" );
+
+	cryptography::AES *receive = dynamic_cast<cryptography::AES *>( crypt::Get( LUA, 3 ) );
+	if( receive == nullptr )
+		LUA->ArgError( 3, "AES crypter expected" );
+
+	if( send == receive )
+		LUA->ArgError( 3, "must be a different crypter than the send one" );
+
+	LUA->CheckType( 4, GarrysMod::Lua::Type::STRING );
+
+	uint32_t peerLen = 0;
+	const uint8_t *peerKey = reinterpret_cast<const uint8_t *>( LUA->GetString( 4, &peerLen ) );
+
+	if( !agreement->Derive(
+		cryptography::bytes( peerKey, peerKey + peerLen ),
+		GetOptionalBytes( LUA, 5 ),
+		GetOptionalBytes( LUA, 6 ),
+		*send,
+		*receive
+	) )
+	{
+		LUA->PushNil( );
+		LUA->PushString( agreement->GetLastError( ).c_str( ) );
+		return 2;
+	}
+
+	LUA->PushBool( true );
+	return 1;
+}
+
+template<typename Agreement>
+static int Creator( lua_State *state )
+{
+	GarrysMod::Lua::ILuaBase *LUA = state->luabase;
+	LUA->SetState( state );
+
+	Agreement *agreement = new( std::nothrow ) Agreement( );
+	if( agreement == nullptr )
+	{
+		LUA->PushNil( );
+		LUA->PushString( "failed to create object" );
+		return 2;
+	}
+
+	if( !agreement->GenerateKeyPair( ) )
+	{
+		LUA->PushNil( );
+		LUA->PushString( agreement->GetLastError( ).c_str( ) );
+		delete agreement;
+		return 2;
+	}
+
+	LUA->PushUserType( agreement, metatype );
+
+	LUA->PushMetaTable( metatype );
+	LUA->SetMetaTable( -2 );
+
+	LUA->CreateTable( );
+	LUA->SetFEnv( -2 );
+
+	return 1;
+}
+
+void Initialize( GarrysMod::Lua::ILuaBase *LUA )
+{
+	metatype = LUA->CreateMetaTable( metaname );
+
+	LUA->PushCFunction( tostring );
+	LUA->SetField( -2, "__tostring" );
+
+	LUA->PushCFunction( eq );
+	LUA->SetField( -2, "__eq" );
+
+	LUA->PushCFunction( index );
+	LUA->SetField( -2, "__index" );
+
+	LUA->PushCFunction( newindex );
+	LUA->SetField( -2, "__newindex" );
+
+	LUA->PushCFunction( gc );
+	LUA->SetField( -2, "__gc" );
+
+	LUA->PushCFunction( gc );
+	LUA->SetField( -2, "Destroy" );
+
+	LUA->PushCFunction( IsValid );
+	LUA->SetField( -2, "IsValid" );
+
+	LUA->PushCFunction( AlgorithmName );
+	LUA->SetField( -2, "AlgorithmName" );
+
+	LUA->PushCFunction( GenerateKeyPair );
+	LUA->SetField( -2, "GenerateKeyPair" );
+
+	LUA->PushCFunction( GetPublicKey );
+	LUA->SetField( -2, "GetPublicKey" );
+
+	LUA->PushCFunction( Derive );
+	LUA->SetField( -2, "Derive" );
+
+	LUA->PushCFunction( DeriveCrypters );
+	LUA->SetField( -2, "DeriveCrypters" );
+
+	LUA->Pop( 1 );
+
+	LUA->PushCFunction( Creator<cryptography::ECDH> );
+	LUA->SetField( -2, "ECDH" );
+
+	LUA->PushCFunction( Creator<cryptography::X25519> );
+	LUA->SetField( -2, "X25519" );
+}
+
+void Deinitialize( GarrysMod::Lua::ILuaBase *LUA )
+{
+	LUA->PushNil( );
+	LUA->SetField( GarrysMod::Lua::INDEX_REGISTRY, metaname );
+}
+
+}
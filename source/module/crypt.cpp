@@ -1,5 +1,6 @@
 #include <crypt.hpp>
 #include <cryptography.hpp>
+#include <envelope.hpp>
 #include <GarrysMod/Lua/Interface.h>
 
 namespace crypt
@@ -21,7 +22,7 @@ static cryptography::Crypter *GetUserData( GarrysMod::Lua::ILuaBase *LUA, int32_
 	return  LUA->GetUserType<cryptography::Crypter>( index, metatype );
 }
 
-static cryptography::Crypter *Get( GarrysMod::Lua::ILuaBase *LUA, int32_t index )
+cryptography::Crypter *Get( GarrysMod::Lua::ILuaBase *LUA, int32_t index )
 {
 	cryptography::Crypter *crypter = GetUserData( LUA, index );
 	if( crypter == nullptr )
@@ -286,6 +287,203 @@ LUA_FUNCTION_STATIC( Encrypt )
 	return 1;
 }
 
+LUA_FUNCTION_STATIC( DecryptMany )
+{
+	cryptography::Crypter *crypter = Get( LUA, 1 );
+	LUA->CheckType( 2, GarrysMod::Lua::Type::TABLE );
+
+	std::vector<cryptography::bytes> encrypted( static_cast<size_t>( LUA->ObjLen( 2 ) ) );
+	for( size_t i = 0; i < encrypted.size( ); ++i )
+	{
+		LUA->PushNumber( static_cast<double>( i + 1 ) );
+		LUA->GetTable( 2 );
+		if( !LUA->IsType( -1, GarrysMod::Lua::Type::STRING ) )
+			LUA->ArgError( 2, "array must only contain strings" );
+
+		uint32_t len = 0;
+		const uint8_t *data = reinterpret_cast<const uint8_t *>( LUA->GetString( -1, &len ) );
+		encrypted[i].assign( data, data + len );
+		LUA->Pop( 1 );
+	}
+
+	std::vector<cryptography::bytes> decrypted;
+	std::vector<std::string> errors;
+	crypter->DecryptMany( encrypted, decrypted, errors );
+
+	// results[i] is the plaintext or false, errors[i] explains each false
+	LUA->CreateTable( );
+	LUA->CreateTable( );
+	for( size_t i = 0; i < decrypted.size( ); ++i )
+	{
+		LUA->PushNumber( static_cast<double>( i + 1 ) );
+		if( errors[i].empty( ) )
+		{
+			LUA->PushString( reinterpret_cast<const char *>( decrypted[i].data( ) ), decrypted[i].size( ) );
+			LUA->SetTable( -4 );
+			continue;
+		}
+
+		LUA->PushBool( false );
+		LUA->SetTable( -4 );
+
+		LUA->PushNumber( static_cast<double>( i + 1 ) );
+		LUA->PushString( errors[i].c_str( ) );
+		LUA->SetTable( -3 );
+	}
+
+	return 2;
+}
+
+LUA_FUNCTION_STATIC( Precompute )
+{
+	cryptography::Crypter *crypter = Get( LUA, 1 );
+	if( !crypter->Precompute( ) )
+	{
+		LUA->PushNil( );
+		LUA->PushString( crypter->GetLastError( ).c_str( ) );
+		return 2;
+	}
+
+	LUA->PushBool( true );
+	return 1;
+}
+
+LUA_FUNCTION_STATIC( SetPrecomputationThreshold )
+{
+	cryptography::Crypter *crypter = Get( LUA, 1 );
+	size_t uses = static_cast<size_t>( LUA->CheckNumber( 2 ) );
+
+	if( !crypter->SetPrecomputationThreshold( uses ) )
+	{
+		LUA->PushNil( );
+		LUA->PushString( crypter->GetLastError( ).c_str( ) );
+		return 2;
+	}
+
+	LUA->PushBool( true );
+	return 1;
+}
+
+LUA_FUNCTION_STATIC( SetEphemeralPoolSize )
+{
+	cryptography::Crypter *crypter = Get( LUA, 1 );
+	size_t size = static_cast<size_t>( LUA->CheckNumber( 2 ) );
+
+	if( !crypter->SetEphemeralPoolSize( size ) )
+	{
+		LUA->PushNil( );
+		LUA->PushString( crypter->GetLastError( ).c_str( ) );
+		return 2;
+	}
+
+	LUA->PushBool( true );
+	return 1;
+}
+
+LUA_FUNCTION_STATIC( SetLatencyMode )
+{
+	cryptography::Crypter *crypter = Get( LUA, 1 );
+	LUA->CheckType( 2, GarrysMod::Lua::Type::BOOL );
+
+	if( !crypter->SetLatencyMode( LUA->GetBool( 2 ) ) )
+	{
+		LUA->PushNil( );
+		LUA->PushString( crypter->GetLastError( ).c_str( ) );
+		return 2;
+	}
+
+	LUA->PushBool( true );
+	return 1;
+}
+
+LUA_FUNCTION_STATIC( Seal )
+{
+	LUA->CheckType( 1, GarrysMod::Lua::Type::STRING );
+	LUA->CheckType( 2, GarrysMod::Lua::Type::TABLE );
+
+	uint32_t len = 0;
+	const uint8_t *data = reinterpret_cast<const uint8_t *>( LUA->GetString( 1, &len ) );
+
+	std::vector<cryptography::Crypter *> recipients( static_cast<size_t>( LUA->ObjLen( 2 ) ) );
+	for( size_t i = 0; i < recipients.size( ); ++i )
+	{
+		LUA->PushNumber( static_cast<double>( i + 1 ) );
+		LUA->GetTable( 2 );
+		if( LUA->IsType( -1, metatype ) )
+			recipients[i] = LUA->GetUserType<cryptography::Crypter>( -1, metatype );
+
+		if( recipients[i] == nullptr )
+			LUA->ArgError( 2, "recipients must be valid crypters" );
+
+		LUA->Pop( 1 );
+	}
+
+	cryptography::bytes body;
+	std::vector<cryptography::bytes> headers;
+	std::vector<std::string> errors;
+	std::string error;
+	if( !cryptography::Seal( cryptography::bytes( data, data + len ), recipients, body, headers, errors, error ) )
+	{
+		LUA->PushNil( );
+		LUA->PushString( error.c_str( ) );
+		return 2;
+	}
+
+	LUA->PushString( reinterpret_cast<const char *>( body.data( ) ), body.size( ) );
+
+	// headers[i] is the wrapped key for recipients[i] or false, errors[i] explains each false
+	LUA->CreateTable( );
+	LUA->CreateTable( );
+	for( size_t i = 0; i < headers.size( ); ++i )
+	{
+		LUA->PushNumber( static_cast<double>( i + 1 ) );
+		if( errors[i].empty( ) )
+		{
+			LUA->PushString( reinterpret_cast<const char *>( headers[i].data( ) ), headers[i].size( ) );
+			LUA->SetTable( -4 );
+			continue;
+		}
+
+		LUA->PushBool( false );
+		LUA->SetTable( -4 );
+
+		LUA->PushNumber( static_cast<double>( i + 1 ) );
+		LUA->PushString( errors[i].c_str( ) );
+		LUA->SetTable( -3 );
+	}
+
+	return 3;
+}
+
+LUA_FUNCTION_STATIC( Open )
+{
+	cryptography::Crypter *crypter = Get( LUA, 1 );
+	LUA->CheckType( 2, GarrysMod::Lua::Type::STRING );
+	LUA->CheckType( 3, GarrysMod::Lua::Type::STRING );
+
+	uint32_t headerLen = 0, bodyLen = 0;
+	const uint8_t *header = reinterpret_cast<const uint8_t *>( LUA->GetString( 2, &headerLen ) );
+	const uint8_t *body = reinterpret_cast<const uint8_t *>( LUA->GetString( 3, &bodyLen ) );
+
+	cryptography::bytes data;
+	std::string error;
+	if( !cryptography::Open(
+		*crypter,
+		cryptography::bytes( header, header + headerLen ),
+		cryptography::bytes( body, body + bodyLen ),
+		data,
+		error
+	) )
+	{
+		LUA->PushNil( );
+		LUA->PushString( error.c_str( ) );
+		return 2;
+	}
+
+	LUA->PushString( reinterpret_cast<const char *>( data.data( ) ), data.size( ) );
+	return 1;
+}
+
 template<typename Crypter>
 static int Creator( lua_State *state )
 {
@@ -375,8 +573,29 @@ void Initialize( GarrysMod::Lua::ILuaBase *LUA )
 	LUA->PushCFunction( Encrypt );
 	LUA->SetField( -2, "Encrypt" );
 
+	LUA->PushCFunction( DecryptMany );
+	LUA->SetField( -2, "DecryptMany" );
+
+	LUA->PushCFunction( Precompute );
+	LUA->SetField( -2, "Precompute" );
+
+	LUA->PushCFunction( SetPrecomputationThreshold );
+	LUA->SetField( -2, "SetPrecomputationThreshold" );
+
+	LUA->PushCFunction( SetEphemeralPoolSize );
+	LUA->SetField( -2, "SetEphemeralPoolSize" );
+
+	LUA->PushCFunction( SetLatencyMode );
+	LUA->SetField( -2, "SetLatencyMode" );
+
 	LUA->Pop( 1 );
 
+	LUA->PushCFunction( Seal );
+	LUA->SetField( -2, "Seal" );
+
+	LUA->PushCFunction( Open );
+	LUA->SetField( -2, "Open" );
+
 	LUA->PushCFunction( Creator<cryptography::AES> );
 	LUA->SetField( -2, "AES" );
 
@@ -389,6 +608,9 @@ void Initialize( GarrysMod::Lua::ILuaBase *LUA )
 
 void Deinitialize( GarrysMod::Lua::ILuaBase *LUA )
 {
+	cryptography::EphemeralPool::Instance( ).Shutdown( );
+	cryptography::ThreadPool::Instance( ).Shutdown( );
+
 	LUA->PushNil( );
 	LUA->SetField( GarrysMod::Lua::INDEX_REGISTRY, metaname );
 }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+
 namespace GarrysMod
 {
 	namespace Lua
@@ -8,10 +10,18 @@ namespace GarrysMod
 	}
 }
 
+namespace cryptography
+{
+	class Crypter;
+}
+
 namespace crypt
 {
 
 void Initialize( GarrysMod::Lua::ILuaBase *LUA );
 void Deinitialize( GarrysMod::Lua::ILuaBase *LUA );
 
+// Returns the crypter at index, raising a Lua error when it isn't a valid one.
+cryptography::Crypter *Get( GarrysMod::Lua::ILuaBase *LUA, int32_t index );
+
 }
@@ -2,6 +2,7 @@
 #include <GarrysMod/Lua/Interface.h>
 #include <GarrysMod/Lua/LuaInterface.h>
 #include <cstdint>
+#include <cstring>
 #include <vector>
 #include <cryptopp/crc.h>
 #include <cryptopp/sha.h>
@@ -11,6 +12,16 @@
 #include <cryptopp/md5.h>
 #include <cryptopp/whrlpool.h>
 #include <cryptopp/ripemd.h>
+#include <cryptopp/blake2.h>
+#include <cryptopp/sha3.h>
+#include <cryptopp/shake.h>
+#include <cryptopp/misc.h>
+#include <crc32.hpp>
+#include <treehash.hpp>
+#include <multihash.hpp>
+#include <clonablehash.hpp>
+#include <hashstate.hpp>
+#include <siphash.hpp>
 
 namespace hash
 {
@@ -19,6 +30,13 @@ static const char *metaname = "hasher";
 static int32_t metatype = GarrysMod::Lua::Type::NONE;
 static const char *invalid_error = "invalid hasher";
 
+// SHA-1 and SHA-2 keep their byte count where ExportState can reach it
+typedef cryptography::ResumableIteratedHash<CryptoPP::SHA1, 20> SHA1;
+typedef cryptography::ResumableIteratedHash<CryptoPP::SHA224, 32> SHA224;
+typedef cryptography::ResumableIteratedHash<CryptoPP::SHA256, 32> SHA256;
+typedef cryptography::ResumableIteratedHash<CryptoPP::SHA384, 64> SHA384;
+typedef cryptography::ResumableIteratedHash<CryptoPP::SHA512, 64> SHA512;
+
 inline void CheckType( GarrysMod::Lua::ILuaBase *LUA, int32_t index )
 {
 	if( !LUA->IsType( index, metatype ) )
@@ -141,19 +159,130 @@ LUA_FUNCTION_STATIC( Update )
 	return 2;
 }
 
+// largest extendable output handed back to Lua in one call
+static const uint32_t MaxOutputLength = 1 << 20;
+
+// The optional output argument is either asNumber, which turns digests of up to 4 bytes (the
+// CRCs) into the little endian value they encode, or the number of bytes to output. SHAKE
+// outputs any length up to MaxOutputLength, every other hasher only truncates. Returns false
+// when the length is over that cap so the caller can return nil and an error.
+static bool GetOutput(
+	GarrysMod::Lua::ILuaBase *LUA,
+	int32_t index,
+	const CryptoPP::HashTransformation *hasher,
+	uint32_t &size,
+	bool &asNumber
+)
+{
+	size = hasher->DigestSize( );
+	asNumber = false;
+	if( LUA->IsType( index, GarrysMod::Lua::Type::NONE ) || LUA->IsType( index, GarrysMod::Lua::Type::NIL ) )
+		return true;
+
+	if( LUA->IsType( index, GarrysMod::Lua::Type::NUMBER ) )
+	{
+		const double length = LUA->GetNumber( index );
+		if( !( length >= 1 ) )
+			LUA->ArgError( index, "output length must be a positive integer" );
+
+		if( length > MaxOutputLength )
+			return false;
+
+		if( length != static_cast<uint32_t>( length ) )
+			LUA->ArgError( index, "output length must be a positive integer" );
+
+		size = static_cast<uint32_t>( length );
+		return true;
+	}
+
+	LUA->CheckType( index, GarrysMod::Lua::Type::BOOL );
+	asNumber = LUA->GetBool( index );
+	if( asNumber && size > 4 )
+		LUA->ArgError( index, "digest is too big to be returned as a number" );
+
+	return true;
+}
+
+static void PushDigest( GarrysMod::Lua::ILuaBase *LUA, const uint8_t *digest, uint32_t size, bool asNumber )
+{
+	if( !asNumber )
+	{
+		LUA->PushString( reinterpret_cast<const char *>( digest ), size );
+		return;
+	}
+
+	uint32_t value = 0;
+	for( uint32_t i = 0; i < size; ++i )
+		value |= static_cast<uint32_t>( digest[i] ) << ( 8 * i );
+
+	LUA->PushNumber( value );
+}
+
+// A multi-hasher returns one value per hash, asNumber only applies to the digests of up to 4
+// bytes and output lengths aren't supported.
+static bool GetMultiOutput( GarrysMod::Lua::ILuaBase *LUA, int32_t index )
+{
+	if( LUA->IsType( index, GarrysMod::Lua::Type::NONE ) || LUA->IsType( index, GarrysMod::Lua::Type::NIL ) )
+		return false;
+
+	LUA->CheckType( index, GarrysMod::Lua::Type::BOOL );
+	return LUA->GetBool( index );
+}
+
+static int PushDigests( GarrysMod::Lua::ILuaBase *LUA, cryptography::MultiHash *multi, bool asNumber )
+{
+	std::vector<cryptography::bytes> digests;
+	multi->Final( digests );
+
+	for( const cryptography::bytes &digest : digests )
+		PushDigest(
+			LUA,
+			digest.data( ),
+			static_cast<uint32_t>( digest.size( ) ),
+			asNumber && digest.size( ) <= 4
+		);
+
+	return static_cast<int>( digests.size( ) );
+}
+
 LUA_FUNCTION_STATIC( Final )
 {
 	CryptoPP::HashTransformation *hasher = Get( LUA, 1 );
 
+	cryptography::MultiHash *multi = dynamic_cast<cryptography::MultiHash *>( hasher );
+	if( multi != nullptr )
+	{
+		const bool asNumber = GetMultiOutput( LUA, 2 );
+
+		try
+		{
+			return PushDigests( LUA, multi, asNumber );
+		}
+		catch( const CryptoPP::Exception &e )
+		{
+			LUA->PushNil( );
+			LUA->PushString( e.what( ) );
+			return 2;
+		}
+	}
+
+	uint32_t size = 0;
+	bool asNumber = false;
+	if( !GetOutput( LUA, 2, hasher, size, asNumber ) )
+	{
+		LUA->PushNil( );
+		LUA->PushString( "output length is too big" );
+		return 2;
+	}
+
 	try
 	{
-		uint32_t size = hasher->DigestSize( );
 		std::vector<uint8_t> digest( size );
 		uint8_t *digestptr = digest.data( );
 
-		hasher->Final( digestptr );
+		hasher->TruncatedFinal( digestptr, size );
 
-		LUA->PushString( reinterpret_cast<char *>( digestptr ), size );
+		PushDigest( LUA, digestptr, size, asNumber );
 		return 1;
 	}
 	catch( const CryptoPP::Exception &e )
@@ -193,15 +322,42 @@ LUA_FUNCTION_STATIC( CalculateDigest )
 	uint32_t len = 0;
 	const uint8_t *data = reinterpret_cast<const uint8_t *>( LUA->GetString( 2, &len ) );
 
+	cryptography::MultiHash *multi = dynamic_cast<cryptography::MultiHash *>( hasher );
+	if( multi != nullptr )
+	{
+		const bool asNumber = GetMultiOutput( LUA, 3 );
+
+		try
+		{
+			multi->Restart( );
+			multi->Update( data, len );
+			return PushDigests( LUA, multi, asNumber );
+		}
+		catch( const CryptoPP::Exception &e )
+		{
+			LUA->PushNil( );
+			LUA->PushString( e.what( ) );
+			return 2;
+		}
+	}
+
+	uint32_t size = 0;
+	bool asNumber = false;
+	if( !GetOutput( LUA, 3, hasher, size, asNumber ) )
+	{
+		LUA->PushNil( );
+		LUA->PushString( "output length is too big" );
+		return 2;
+	}
+
 	try
 	{
-		uint32_t size = hasher->DigestSize( );
 		std::vector<uint8_t> digest( size );
 		uint8_t *digestptr = digest.data( );
 
-		hasher->CalculateDigest( digestptr, data, len );
+		hasher->CalculateTruncatedDigest( digestptr, size, data, len );
 
-		LUA->PushString( reinterpret_cast<char *>( digestptr ), size );
+		PushDigest( LUA, digestptr, size, asNumber );
 		return 1;
 	}
 	catch( const CryptoPP::Exception &e )
@@ -231,20 +387,195 @@ LUA_FUNCTION_STATIC( OptimalBlockSize )
 	return 1;
 }
 
-template<typename Hasher, bool Secure = true>
-static int Creator( lua_State *state )
+// crypt.SipHash( key, data ), key is 16 bytes
+LUA_FUNCTION_STATIC( SipHash24 )
 {
-	GarrysMod::Lua::ILuaBase *LUA = state->luabase;
-	LUA->SetState( state );
+	LUA->CheckType( 1, GarrysMod::Lua::Type::STRING );
+	LUA->CheckType( 2, GarrysMod::Lua::Type::STRING );
+
+	uint32_t keylen = 0, len = 0;
+	const uint8_t *key = reinterpret_cast<const uint8_t *>( LUA->GetString( 1, &keylen ) );
+	const uint8_t *data = reinterpret_cast<const uint8_t *>( LUA->GetString( 2, &len ) );
+
+	try
+	{
+		cryptography::SipHash siphash( key, keylen );
+		LUA->PushNumber( cryptography::SipHashNumber( siphash, data, len ) );
+		return 1;
+	}
+	catch( const CryptoPP::Exception &e )
+	{
+		LUA->PushNil( );
+		LUA->PushString( e.what( ) );
+	}
+
+	return 2;
+}
+
+// crypt.SipHashMany( key, array ), one number per string in array
+LUA_FUNCTION_STATIC( SipHash24Many )
+{
+	LUA->CheckType( 1, GarrysMod::Lua::Type::STRING );
+	LUA->CheckType( 2, GarrysMod::Lua::Type::TABLE );
+
+	uint32_t keylen = 0;
+	const uint8_t *key = reinterpret_cast<const uint8_t *>( LUA->GetString( 1, &keylen ) );
+
+	cryptography::SipHash siphash;
+	try
+	{
+		siphash.SetKey( key, keylen );
+	}
+	catch( const CryptoPP::Exception &e )
+	{
+		LUA->PushNil( );
+		LUA->PushString( e.what( ) );
+		return 2;
+	}
+
+	const size_t count = static_cast<size_t>( LUA->ObjLen( 2 ) );
+	LUA->CreateTable( );
+	for( size_t i = 1; i <= count; ++i )
+	{
+		LUA->PushNumber( static_cast<double>( i ) );
+		LUA->PushNumber( static_cast<double>( i ) );
+		LUA->GetTable( 2 );
+		if( !LUA->IsType( -1, GarrysMod::Lua::Type::STRING ) )
+			LUA->ArgError( 2, "array must only contain strings" );
+
+		uint32_t len = 0;
+		const uint8_t *data = reinterpret_cast<const uint8_t *>( LUA->GetString( -1, &len ) );
+		const double value = cryptography::SipHashNumber( siphash, data, len );
+		LUA->Pop( 1 );
+
+		LUA->PushNumber( value );
+		LUA->SetTable( -3 );
+	}
+
+	return 1;
+}
+
+static void Push( GarrysMod::Lua::ILuaBase *LUA, CryptoPP::HashTransformation *hasher )
+{
+	LUA->PushUserType( hasher, metatype );
+
+	LUA->PushMetaTable( metatype );
+	LUA->SetMetaTable( -2 );
+
+	LUA->CreateTable( );
+	LUA->SetFEnv( -2 );
+}
+
+// hasher:Clone( ), a copy of the whole state, whatever has been absorbed included
+LUA_FUNCTION_STATIC( Clone )
+{
+	CryptoPP::HashTransformation *hasher = Get( LUA, 1 );
+
+	try
+	{
+		CryptoPP::HashTransformation *clone = static_cast<CryptoPP::HashTransformation *>( hasher->Clone( ) );
+		Push( LUA, clone );
+		return 1;
+	}
+	catch( const CryptoPP::Exception &e )
+	{
+		LUA->PushNil( );
+		LUA->PushString( e.what( ) );
+	}
+
+	return 2;
+}
+
+// hasher:ExportState( ), a string crypt.ImportHashState turns back into this hasher
+LUA_FUNCTION_STATIC( ExportState )
+{
+	CryptoPP::HashTransformation *hasher = Get( LUA, 1 );
+
+	const cryptography::ResumableHash *resumable = dynamic_cast<const cryptography::ResumableHash *>( hasher );
+	if( resumable == nullptr )
+	{
+		LUA->PushNil( );
+		LUA->PushFormattedString( "%s hasher state can't be exported", hasher->AlgorithmName( ).c_str( ) );
+		return 2;
+	}
+
+	cryptography::bytes state;
+	resumable->ExportState( state );
+	LUA->PushString( reinterpret_cast<const char *>( state.data( ) ), static_cast<uint32_t>( state.size( ) ) );
+	return 1;
+}
 
+template<typename Hasher, bool Secure>
+inline void WarnInsecure( GarrysMod::Lua::ILuaBase *LUA )
+{
 	// let's annoy everyone to force them to drop insecure algorithms
 	if( !Secure )
 		static_cast<GarrysMod::Lua::ILuaInterface *>( LUA )->ErrorNoHalt(
 			"[gm_crypt] %s hashing algorithm is considered insecure!\n",
-			Hasher::StaticAlgorithmName( )
+			std::string( Hasher::StaticAlgorithmName( ) ).c_str( )
 		);
+}
+
+template<typename Hasher, bool Secure = true>
+static CryptoPP::HashTransformation *New( GarrysMod::Lua::ILuaBase *LUA )
+{
+	WarnInsecure<Hasher, Secure>( LUA );
+	return new( std::nothrow ) Hasher( );
+}
+
+// crypt.X( data[, output] ), digests data on a hasher kept per thread and type, so there is no
+// allocation, userdata or garbage left behind
+template<typename Hasher, bool Secure>
+static int OneShot( GarrysMod::Lua::ILuaBase *LUA )
+{
+	WarnInsecure<Hasher, Secure>( LUA );
+
+	static thread_local Hasher hasher;
+	uint32_t size = 0;
+	bool asNumber = false;
+	if( !GetOutput( LUA, 2, &hasher, size, asNumber ) )
+	{
+		LUA->PushNil( );
+		LUA->PushString( "output length is too big" );
+		return 2;
+	}
+
+	uint32_t len = 0;
+	const uint8_t *data = reinterpret_cast<const uint8_t *>( LUA->GetString( 1, &len ) );
+
+	try
+	{
+		// only extendable output asks for more than the largest fixed digest
+		uint8_t fixed[64];
+		std::vector<uint8_t> extended( size > sizeof( fixed ) ? size : 0 );
+		uint8_t *digestptr = extended.empty( ) ? fixed : extended.data( );
+
+		hasher.Restart( );
+		hasher.CalculateTruncatedDigest( digestptr, size, data, len );
+
+		PushDigest( LUA, digestptr, size, asNumber );
+		return 1;
+	}
+	catch( const CryptoPP::Exception &e )
+	{
+		LUA->PushNil( );
+		LUA->PushString( e.what( ) );
+	}
 
-	Hasher *hasher = new( std::nothrow ) Hasher( );
+	return 2;
+}
+
+// crypt.X( ) creates a hasher, crypt.X( data[, output] ) is the one-shot digest
+template<typename Hasher, bool Secure = true>
+static int Creator( lua_State *state )
+{
+	GarrysMod::Lua::ILuaBase *LUA = state->luabase;
+	LUA->SetState( state );
+
+	if( LUA->IsType( 1, GarrysMod::Lua::Type::STRING ) )
+		return OneShot<Hasher, Secure>( LUA );
+
+	CryptoPP::HashTransformation *hasher = New<Hasher, Secure>( LUA );
 	if( hasher == nullptr )
 	{
 		LUA->PushNil( );
@@ -252,14 +583,175 @@ static int Creator( lua_State *state )
 		return 2;
 	}
 
-	LUA->PushUserType( hasher, metatype );
+	Push( LUA, hasher );
+	return 1;
+}
 
-	LUA->PushMetaTable( metatype );
-	LUA->SetMetaTable( -2 );
+// crypt.TreeHash( [chunkSize] ), see readme.md for the output format
+LUA_FUNCTION_STATIC( TreeHashCreator )
+{
+	size_t chunkSize = cryptography::TreeHash::DefaultChunkSize;
+	if( !LUA->IsType( 1, GarrysMod::Lua::Type::NONE ) && !LUA->IsType( 1, GarrysMod::Lua::Type::NIL ) )
+	{
+		const double size = LUA->CheckNumber( 1 );
+		if( size < cryptography::TreeHash::MinChunkSize || size > cryptography::TreeHash::MaxChunkSize )
+			LUA->ArgError( 1, "chunk size must be between 1 KiB and 1 GiB" );
 
-	LUA->CreateTable( );
-	LUA->SetFEnv( -2 );
+		chunkSize = static_cast<size_t>( size );
+	}
 
+	cryptography::TreeHash *hasher = new( std::nothrow ) cryptography::TreeHash( chunkSize );
+	if( hasher == nullptr )
+	{
+		LUA->PushNil( );
+		LUA->PushString( "failed to create object" );
+		return 2;
+	}
+
+	Push( LUA, hasher );
+	return 1;
+}
+
+// the fixed size hashers a multi-hasher can be made of, by the name they have in crypt
+static const struct
+{
+	const char *name;
+	CryptoPP::HashTransformation *( *create )( GarrysMod::Lua::ILuaBase *LUA );
+} multi_algorithms[] = {
+	{ "CRC32", New<cryptography::CRC32> },
+	{ "CRC32C", New<cryptography::CRC32C> },
+	{ "SHA1", New<SHA1> },
+	{ "SHA224", New<SHA224> },
+	{ "SHA256", New<SHA256> },
+	{ "SHA384", New<SHA384> },
+	{ "SHA512", New<SHA512> },
+	{ "SHA3_224", New< cryptography::ClonableHash<CryptoPP::SHA3_224> > },
+	{ "SHA3_256", New< cryptography::ClonableHash<CryptoPP::SHA3_256> > },
+	{ "SHA3_384", New< cryptography::ClonableHash<CryptoPP::SHA3_384> > },
+	{ "SHA3_512", New< cryptography::ClonableHash<CryptoPP::SHA3_512> > },
+	{ "BLAKE2b", New< cryptography::ClonableHash<CryptoPP::BLAKE2b> > },
+	{ "BLAKE2s", New< cryptography::ClonableHash<CryptoPP::BLAKE2s> > },
+	{ "Tiger", New<CryptoPP::Tiger> },
+	{ "Whirlpool", New<CryptoPP::Whirlpool> },
+	{ "MD2", New<CryptoPP::Weak::MD2, false> },
+	{ "MD4", New<CryptoPP::Weak::MD4, false> },
+	{ "MD5", New<CryptoPP::Weak::MD5, false> },
+	{ "RIPEMD128", New<CryptoPP::RIPEMD128, false> },
+	{ "RIPEMD160", New<CryptoPP::RIPEMD160> },
+	{ "RIPEMD256", New<CryptoPP::RIPEMD256, false> },
+	{ "RIPEMD320", New<CryptoPP::RIPEMD320> }
+};
+
+// crypt.MultiHash( array ), array holds algorithm names like { "CRC32", "MD5", "SHA256" } and
+// Final returns one digest per name, in the same order
+LUA_FUNCTION_STATIC( MultiHashCreator )
+{
+	LUA->CheckType( 1, GarrysMod::Lua::Type::TABLE );
+
+	const size_t count = static_cast<size_t>( LUA->ObjLen( 1 ) );
+	if( count == 0 )
+		LUA->ArgError( 1, "array must contain at least one algorithm" );
+
+	std::vector<size_t> chosen( count );
+	for( size_t i = 0; i < count; ++i )
+	{
+		LUA->PushNumber( static_cast<double>( i + 1 ) );
+		LUA->GetTable( 1 );
+		if( !LUA->IsType( -1, GarrysMod::Lua::Type::STRING ) )
+			LUA->ArgError( 1, "array must only contain strings" );
+
+		const char *name = LUA->GetString( -1 );
+		const size_t algorithms = sizeof( multi_algorithms ) / sizeof( *multi_algorithms );
+		size_t k = 0;
+		while( k < algorithms && std::strcmp( multi_algorithms[k].name, name ) != 0 )
+			++k;
+
+		if( k == algorithms )
+			LUA->ArgError( 1, "array contains an unknown hashing algorithm" );
+
+		chosen[i] = k;
+		LUA->Pop( 1 );
+	}
+
+	cryptography::MultiHash *hasher = new( std::nothrow ) cryptography::MultiHash( );
+	if( hasher == nullptr )
+	{
+		LUA->PushNil( );
+		LUA->PushString( "failed to create object" );
+		return 2;
+	}
+
+	for( size_t k : chosen )
+	{
+		CryptoPP::HashTransformation *hash = multi_algorithms[k].create( LUA );
+		if( hash == nullptr )
+		{
+			delete hasher;
+			LUA->PushNil( );
+			LUA->PushString( "failed to create object" );
+			return 2;
+		}
+
+		hasher->Add( hash );
+	}
+
+	Push( LUA, hasher );
+	return 1;
+}
+
+// the hashers ExportState works on, by AlgorithmName
+static const struct
+{
+	const char *name;
+	CryptoPP::HashTransformation *( *create )( GarrysMod::Lua::ILuaBase *LUA );
+} resumable_algorithms[] = {
+	{ "CRC32", New<cryptography::CRC32> },
+	{ "CRC32C", New<cryptography::CRC32C> },
+	{ "SHA-1", New<SHA1> },
+	{ "SHA-224", New<SHA224> },
+	{ "SHA-256", New<SHA256> },
+	{ "SHA-384", New<SHA384> },
+	{ "SHA-512", New<SHA512> }
+};
+
+// crypt.ImportHashState( state ), a new hasher continuing from hasher:ExportState( )
+LUA_FUNCTION_STATIC( ImportState )
+{
+	LUA->CheckType( 1, GarrysMod::Lua::Type::STRING );
+
+	uint32_t len = 0;
+	const uint8_t *data = reinterpret_cast<const uint8_t *>( LUA->GetString( 1, &len ) );
+	const cryptography::bytes state( data, data + len );
+
+	CryptoPP::HashTransformation *hasher = nullptr;
+	try
+	{
+		const std::string name = cryptography::HashStateAlgorithm( state );
+		for( const auto &algorithm : resumable_algorithms )
+			if( name == algorithm.name )
+			{
+				hasher = algorithm.create( LUA );
+				break;
+			}
+
+		if( hasher == nullptr )
+		{
+			LUA->PushNil( );
+			LUA->PushString( "hash state belongs to an unknown algorithm" );
+			return 2;
+		}
+
+		dynamic_cast<cryptography::ResumableHash *>( hasher )->ImportState( state );
+	}
+	catch( const CryptoPP::Exception &e )
+	{
+		delete hasher;
+		LUA->PushNil( );
+		LUA->PushString( e.what( ) );
+		return 2;
+	}
+
+	Push( LUA, hasher );
 	return 1;
 }
 
@@ -309,26 +801,59 @@ void Initialize( GarrysMod::Lua::ILuaBase *LUA )
 	LUA->PushCFunction( OptimalBlockSize );
 	LUA->SetField( -2, "OptimalBlockSize" );
 
+	LUA->PushCFunction( Clone );
+	LUA->SetField( -2, "Clone" );
+
+	LUA->PushCFunction( ExportState );
+	LUA->SetField( -2, "ExportState" );
+
 	LUA->Pop( 1 );
 
-	LUA->PushCFunction( Creator<CryptoPP::CRC32> );
+	LUA->PushCFunction( Creator<cryptography::CRC32> );
 	LUA->SetField( -2, "CRC32" );
 
-	LUA->PushCFunction( Creator<CryptoPP::SHA1> );
+	LUA->PushCFunction( Creator<cryptography::CRC32C> );
+	LUA->SetField( -2, "CRC32C" );
+
+	LUA->PushCFunction( Creator<SHA1> );
 	LUA->SetField( -2, "SHA1" );
 
-	LUA->PushCFunction( Creator<CryptoPP::SHA224> );
+	LUA->PushCFunction( Creator<SHA224> );
 	LUA->SetField( -2, "SHA224" );
 
-	LUA->PushCFunction( Creator<CryptoPP::SHA256> );
+	LUA->PushCFunction( Creator<SHA256> );
 	LUA->SetField( -2, "SHA256" );
 
-	LUA->PushCFunction( Creator<CryptoPP::SHA384> );
+	LUA->PushCFunction( Creator<SHA384> );
 	LUA->SetField( -2, "SHA384" );
 
-	LUA->PushCFunction( Creator<CryptoPP::SHA512> );
+	LUA->PushCFunction( Creator<SHA512> );
 	LUA->SetField( -2, "SHA512" );
 
+	LUA->PushCFunction( Creator< cryptography::ClonableHash<CryptoPP::SHA3_224> > );
+	LUA->SetField( -2, "SHA3_224" );
+
+	LUA->PushCFunction( Creator< cryptography::ClonableHash<CryptoPP::SHA3_256> > );
+	LUA->SetField( -2, "SHA3_256" );
+
+	LUA->PushCFunction( Creator< cryptography::ClonableHash<CryptoPP::SHA3_384> > );
+	LUA->SetField( -2, "SHA3_384" );
+
+	LUA->PushCFunction( Creator< cryptography::ClonableHash<CryptoPP::SHA3_512> > );
+	LUA->SetField( -2, "SHA3_512" );
+
+	LUA->PushCFunction( Creator< cryptography::ClonableHash<CryptoPP::SHAKE128> > );
+	LUA->SetField( -2, "SHAKE128" );
+
+	LUA->PushCFunction( Creator< cryptography::ClonableHash<CryptoPP::SHAKE256> > );
+	LUA->SetField( -2, "SHAKE256" );
+
+	LUA->PushCFunction( Creator< cryptography::ClonableHash<CryptoPP::BLAKE2b> > );
+	LUA->SetField( -2, "BLAKE2b" );
+
+	LUA->PushCFunction( Creator< cryptography::ClonableHash<CryptoPP::BLAKE2s> > );
+	LUA->SetField( -2, "BLAKE2s" );
+
 	LUA->PushCFunction( Creator<CryptoPP::Tiger> );
 	LUA->SetField( -2, "Tiger" );
 
@@ -355,6 +880,21 @@ void Initialize( GarrysMod::Lua::ILuaBase *LUA )
 
 	LUA->PushCFunction( Creator<CryptoPP::RIPEMD320> );
 	LUA->SetField( -2, "RIPEMD320" );
+
+	LUA->PushCFunction( TreeHashCreator );
+	LUA->SetField( -2, "TreeHash" );
+
+	LUA->PushCFunction( MultiHashCreator );
+	LUA->SetField( -2, "MultiHash" );
+
+	LUA->PushCFunction( ImportState );
+	LUA->SetField( -2, "ImportHashState" );
+
+	LUA->PushCFunction( SipHash24 );
+	LUA->SetField( -2, "SipHash" );
+
+	LUA->PushCFunction( SipHash24Many );
+	LUA->SetField( -2, "SipHashMany" );
 }
 
 void Deinitialize( GarrysMod::Lua::ILuaBase *LUA )
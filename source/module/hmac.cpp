@@ -1,8 +1,14 @@
 #include <hmac.hpp>
+#include <precomputedhmac.hpp>
+#include <batchdigest.hpp>
+#include <noncemac.hpp>
+#include <clonablehash.hpp>
 #include <GarrysMod/Lua/Interface.h>
 #include <GarrysMod/Lua/LuaInterface.h>
 #include <cstdint>
 #include <vector>
+#include <memory>
+#include <atomic>
 #include <cryptopp/crc.h>
 #include <cryptopp/sha.h>
 #include <cryptopp/tiger.h>
@@ -11,8 +17,12 @@
 #include <cryptopp/md5.h>
 #include <cryptopp/whrlpool.h>
 #include <cryptopp/ripemd.h>
-#include <cryptopp/hmac.h>
 #include <cryptopp/osrng.h>
+#include <cryptopp/aes.h>
+#include <cryptopp/cmac.h>
+#include <cryptopp/poly1305.h>
+#include <cryptopp/vmac.h>
+#include <cryptopp/blake2.h>
 
 namespace hmac
 {
@@ -28,21 +38,44 @@ inline void CheckType( GarrysMod::Lua::ILuaBase *LUA, int32_t index )
 		LUA->TypeError( index, metaname );
 }
 
-static CryptoPP::HMAC_Base *GetUserData( GarrysMod::Lua::ILuaBase *LUA, int32_t index )
+static CryptoPP::MessageAuthenticationCode *GetUserData( GarrysMod::Lua::ILuaBase *LUA, int32_t index )
 {
 	CheckType( LUA, index );
-	return LUA->GetUserType<CryptoPP::HMAC_Base>( index, metatype );
+	return LUA->GetUserType<CryptoPP::MessageAuthenticationCode>( index, metatype );
 }
 
-static CryptoPP::HMAC_Base *Get( GarrysMod::Lua::ILuaBase *LUA, int32_t index )
+static CryptoPP::MessageAuthenticationCode *Get( GarrysMod::Lua::ILuaBase *LUA, int32_t index )
 {
-	CryptoPP::HMAC_Base *hmac = GetUserData( LUA, index );
+	CryptoPP::MessageAuthenticationCode *hmac = GetUserData( LUA, index );
 	if( hmac == nullptr )
 		LUA->ArgError( index, invalid_error );
 
 	return hmac;
 }
 
+static void GetStrings(
+	GarrysMod::Lua::ILuaBase *LUA,
+	int32_t index,
+	std::vector<cryptography::bytes> &strings
+)
+{
+	LUA->CheckType( index, GarrysMod::Lua::Type::TABLE );
+
+	strings.resize( static_cast<size_t>( LUA->ObjLen( index ) ) );
+	for( size_t i = 0; i < strings.size( ); ++i )
+	{
+		LUA->PushNumber( static_cast<double>( i + 1 ) );
+		LUA->GetTable( index );
+		if( !LUA->IsType( -1, GarrysMod::Lua::Type::STRING ) )
+			LUA->ArgError( index, "array must only contain strings" );
+
+		uint32_t len = 0;
+		const uint8_t *data = reinterpret_cast<const uint8_t *>( LUA->GetString( -1, &len ) );
+		strings[i].assign( data, data + len );
+		LUA->Pop( 1 );
+	}
+}
+
 LUA_FUNCTION_STATIC( tostring )
 {
 
@@ -96,7 +129,7 @@ LUA_FUNCTION_STATIC( newindex )
 
 LUA_FUNCTION_STATIC( gc )
 {
-	CryptoPP::HMAC_Base *hmac = GetUserData( LUA, 1 );
+	CryptoPP::MessageAuthenticationCode *hmac = GetUserData( LUA, 1 );
 	if( hmac == nullptr )
 		return 0;
 
@@ -122,7 +155,7 @@ LUA_FUNCTION_STATIC( IsValid )
 
 LUA_FUNCTION_STATIC( Update )
 {
-	CryptoPP::HMAC_Base *hmac = Get( LUA, 1 );
+	CryptoPP::MessageAuthenticationCode *hmac = Get( LUA, 1 );
 	LUA->CheckType( 2, GarrysMod::Lua::Type::STRING );
 
 	uint32_t len = 0;
@@ -146,7 +179,7 @@ LUA_FUNCTION_STATIC( Update )
 
 LUA_FUNCTION_STATIC( Final )
 {
-	CryptoPP::HMAC_Base *hmac = Get( LUA, 1 );
+	CryptoPP::MessageAuthenticationCode *hmac = Get( LUA, 1 );
 
 	try
 	{
@@ -170,7 +203,7 @@ LUA_FUNCTION_STATIC( Final )
 
 LUA_FUNCTION_STATIC( Restart )
 {
-	CryptoPP::HMAC_Base *hmac = Get( LUA, 1 );
+	CryptoPP::MessageAuthenticationCode *hmac = Get( LUA, 1 );
 
 	try
 	{
@@ -190,7 +223,7 @@ LUA_FUNCTION_STATIC( Restart )
 
 LUA_FUNCTION_STATIC( CalculateDigest )
 {
-	CryptoPP::HMAC_Base *hmac = Get( LUA, 1 );
+	CryptoPP::MessageAuthenticationCode *hmac = Get( LUA, 1 );
 	LUA->CheckType( 2, GarrysMod::Lua::Type::STRING );
 
 	uint32_t len = 0;
@@ -216,6 +249,120 @@ LUA_FUNCTION_STATIC( CalculateDigest )
 	return 2;
 }
 
+// the tag has to be exactly DigestSize bytes, it is compared in constant time
+LUA_FUNCTION_STATIC( Verify )
+{
+	CryptoPP::MessageAuthenticationCode *hmac = Get( LUA, 1 );
+	LUA->CheckType( 2, GarrysMod::Lua::Type::STRING );
+	LUA->CheckType( 3, GarrysMod::Lua::Type::STRING );
+
+	uint32_t len = 0, taglen = 0;
+	const uint8_t *data = reinterpret_cast<const uint8_t *>( LUA->GetString( 2, &len ) );
+	const uint8_t *tag = reinterpret_cast<const uint8_t *>( LUA->GetString( 3, &taglen ) );
+
+	try
+	{
+		if( taglen != hmac->DigestSize( ) )
+		{
+			hmac->Restart( );
+			LUA->PushBool( false );
+			return 1;
+		}
+
+		LUA->PushBool( hmac->VerifyDigest( tag, data, len ) );
+		return 1;
+	}
+	catch( const CryptoPP::Exception &e )
+	{
+		LUA->PushNil( );
+		LUA->PushString( e.what( ) );
+	}
+
+	return 2;
+}
+
+// Batches run every message under the same state, which a MAC that takes a nonce per message
+// (Poly1305, VMAC) can't do: the second tag would reuse the nonce and NonceMAC refuses it.
+static CryptoPP::MessageAuthenticationCode *GetBatchable( GarrysMod::Lua::ILuaBase *LUA, int32_t index )
+{
+	CryptoPP::MessageAuthenticationCode *hmac = Get( LUA, index );
+	if( hmac->IsResynchronizable( ) )
+		LUA->ArgError( index, "MACs that take a nonce need Resynchronize before every message, batch calls aren't supported" );
+
+	return hmac;
+}
+
+// hmac:DigestMany( messages[, parallel] ), one tag per message, not for MACs that take a nonce
+LUA_FUNCTION_STATIC( DigestMany )
+{
+	CryptoPP::MessageAuthenticationCode *hmac = GetBatchable( LUA, 1 );
+
+	std::vector<cryptography::bytes> messages;
+	GetStrings( LUA, 2, messages );
+	const bool parallel = LUA->IsType( 3, GarrysMod::Lua::Type::BOOL ) && LUA->GetBool( 3 );
+
+	try
+	{
+		std::vector<cryptography::bytes> tags;
+		cryptography::DigestMany( *hmac, messages, tags, parallel );
+
+		LUA->CreateTable( );
+		for( size_t i = 0; i < tags.size( ); ++i )
+		{
+			LUA->PushNumber( static_cast<double>( i + 1 ) );
+			LUA->PushString( reinterpret_cast<const char *>( tags[i].data( ) ), tags[i].size( ) );
+			LUA->SetTable( -3 );
+		}
+
+		return 1;
+	}
+	catch( const CryptoPP::Exception &e )
+	{
+		LUA->PushNil( );
+		LUA->PushString( e.what( ) );
+	}
+
+	return 2;
+}
+
+// hmac:VerifyMany( messages, tags[, parallel] ), one boolean per message, not for MACs that take
+// a nonce
+LUA_FUNCTION_STATIC( VerifyMany )
+{
+	CryptoPP::MessageAuthenticationCode *hmac = GetBatchable( LUA, 1 );
+
+	std::vector<cryptography::bytes> messages, tags;
+	GetStrings( LUA, 2, messages );
+	GetStrings( LUA, 3, tags );
+	if( tags.size( ) != messages.size( ) )
+		LUA->ArgError( 3, "must have one tag per message" );
+
+	const bool parallel = LUA->IsType( 4, GarrysMod::Lua::Type::BOOL ) && LUA->GetBool( 4 );
+
+	try
+	{
+		std::vector<uint8_t> valid;
+		cryptography::VerifyMany( *hmac, messages, tags, valid, parallel );
+
+		LUA->CreateTable( );
+		for( size_t i = 0; i < valid.size( ); ++i )
+		{
+			LUA->PushNumber( static_cast<double>( i + 1 ) );
+			LUA->PushBool( valid[i] != 0 );
+			LUA->SetTable( -3 );
+		}
+
+		return 1;
+	}
+	catch( const CryptoPP::Exception &e )
+	{
+		LUA->PushNil( );
+		LUA->PushString( e.what( ) );
+	}
+
+	return 2;
+}
+
 LUA_FUNCTION_STATIC( AlgorithmName )
 {
 	LUA->PushString( Get( LUA, 1 )->AlgorithmName( ).c_str( ) );
@@ -262,7 +409,7 @@ LUA_FUNCTION_STATIC( GetValidKeyLength )
 
 LUA_FUNCTION_STATIC( SetKey )
 {
-	CryptoPP::HMAC_Base *hmac = Get( LUA, 1 );
+	CryptoPP::MessageAuthenticationCode *hmac = Get( LUA, 1 );
 	LUA->CheckType( 2, GarrysMod::Lua::Type::STRING );
 
 	uint32_t keylen = 0;
@@ -270,7 +417,18 @@ LUA_FUNCTION_STATIC( SetKey )
 
 	try
 	{
-		hmac->SetKey( key, keylen );
+		// MACs that need a nonce (Poly1305, VMAC) take it along with the key
+		if( LUA->IsType( 3, GarrysMod::Lua::Type::STRING ) )
+		{
+			uint32_t ivlen = 0;
+			const uint8_t *iv = reinterpret_cast<const uint8_t *>( LUA->GetString( 3, &ivlen ) );
+			hmac->SetKeyWithIV( key, keylen, iv, ivlen );
+		}
+		else
+		{
+			hmac->SetKey( key, keylen );
+		}
+
 		LUA->PushBool( true );
 		return 1;
 	}
@@ -283,20 +441,157 @@ LUA_FUNCTION_STATIC( SetKey )
 	return 2;
 }
 
-template<typename Hasher, bool Secure = true>
-static int Creator( lua_State *state )
+LUA_FUNCTION_STATIC( IVSize )
 {
-	GarrysMod::Lua::ILuaBase *LUA = state->luabase;
-	LUA->SetState( state );
+	CryptoPP::MessageAuthenticationCode *hmac = Get( LUA, 1 );
+	LUA->PushNumber( hmac->IsResynchronizable( ) ? hmac->IVSize( ) : 0 );
+	return 1;
+}
+
+LUA_FUNCTION_STATIC( Resynchronize )
+{
+	CryptoPP::MessageAuthenticationCode *hmac = Get( LUA, 1 );
+	LUA->CheckType( 2, GarrysMod::Lua::Type::STRING );
+
+	uint32_t ivlen = 0;
+	const uint8_t *iv = reinterpret_cast<const uint8_t *>( LUA->GetString( 2, &ivlen ) );
+
+	try
+	{
+		hmac->Resynchronize( iv, static_cast<int>( ivlen ) );
+		LUA->PushBool( true );
+		return 1;
+	}
+	catch( const CryptoPP::Exception &e )
+	{
+		LUA->PushNil( );
+		LUA->PushString( e.what( ) );
+	}
+
+	return 2;
+}
 
+static void Push( GarrysMod::Lua::ILuaBase *LUA, CryptoPP::MessageAuthenticationCode *hmac )
+{
+	LUA->PushUserType( hmac, metatype );
+
+	LUA->PushMetaTable( metatype );
+	LUA->SetMetaTable( -2 );
+
+	LUA->CreateTable( );
+	LUA->SetFEnv( -2 );
+}
+
+LUA_FUNCTION_STATIC( Clone )
+{
+	CryptoPP::MessageAuthenticationCode *hmac = Get( LUA, 1 );
+
+	try
+	{
+		CryptoPP::MessageAuthenticationCode *clone =
+			static_cast<CryptoPP::MessageAuthenticationCode *>( hmac->Clone( ) );
+		Push( LUA, clone );
+		return 1;
+	}
+	catch( const CryptoPP::Exception &e )
+	{
+		LUA->PushNil( );
+		LUA->PushString( e.what( ) );
+	}
+
+	return 2;
+}
+
+template<typename Hasher, bool Secure>
+inline void WarnInsecure( GarrysMod::Lua::ILuaBase *LUA )
+{
 	// let's annoy everyone to force them to drop insecure algorithms
 	if( !Secure )
 		static_cast<GarrysMod::Lua::ILuaInterface *>( LUA )->ErrorNoHalt(
 			"[gm_crypt] %s HMAC algorithm is considered insecure!\n",
 			Hasher::StaticAlgorithmName( )
 		);
+}
+
+// The keyed HMAC and its key kept by OneShot for each hasher type on this thread. Every type
+// takes a slot on first use and Deinitialize drops them all, so no key or midstate derived
+// from one outlives the module.
+struct OneShotState
+{
+	OneShotState( ) :
+		keyed( false )
+	{ }
+
+	std::unique_ptr<CryptoPP::MessageAuthenticationCode> hmac;
+	CryptoPP::SecByteBlock lastKey;
+	bool keyed;
+};
+
+static std::atomic<size_t> oneshot_slots( 0 );
+static thread_local std::vector<OneShotState> oneshot_states;
+
+// crypt.hmac.X( key, data ), the tag of data from an HMAC kept per thread and type. The
+// ipad/opad midstates are only recomputed when the key differs from the previous call's.
+template<typename Hasher, bool Secure>
+static int OneShot( GarrysMod::Lua::ILuaBase *LUA )
+{
+	WarnInsecure<Hasher, Secure>( LUA );
+
+	uint32_t keylen = 0, len = 0;
+	const uint8_t *key = reinterpret_cast<const uint8_t *>( LUA->GetString( 1, &keylen ) );
+	const uint8_t *data = reinterpret_cast<const uint8_t *>( LUA->GetString( 2, &len ) );
+
+	static const size_t slot = oneshot_slots++;
+	if( oneshot_states.size( ) <= slot )
+		oneshot_states.resize( slot + 1 );
+
+	OneShotState &state = oneshot_states[slot];
+
+	try
+	{
+		if( !state.keyed || state.lastKey.size( ) != keylen ||
+			!CryptoPP::VerifyBufsEqual( state.lastKey, key, keylen ) )
+		{
+			state.keyed = false;
+			if( !state.hmac )
+				state.hmac.reset( new cryptography::PrecomputedHMAC<Hasher>( ) );
+
+			state.hmac->SetKey( key, keylen );
+			state.lastKey.Assign( key, keylen );
+			state.keyed = true;
+		}
+
+		uint8_t digest[Hasher::DIGESTSIZE];
+		state.hmac->Restart( );
+		state.hmac->CalculateDigest( digest, data, len );
+
+		LUA->PushString( reinterpret_cast<const char *>( digest ), sizeof( digest ) );
+		return 1;
+	}
+	catch( const CryptoPP::Exception &e )
+	{
+		LUA->PushNil( );
+		LUA->PushString( e.what( ) );
+	}
+
+	return 2;
+}
+
+// crypt.hmac.X( [key] ), keyed with a random key when none is given, and
+// crypt.hmac.X( key, data ) for the one-shot tag
+template<typename Hasher, bool Secure = true>
+static int Creator( lua_State *state )
+{
+	GarrysMod::Lua::ILuaBase *LUA = state->luabase;
+	LUA->SetState( state );
+
+	if( LUA->IsType( 1, GarrysMod::Lua::Type::STRING ) && LUA->IsType( 2, GarrysMod::Lua::Type::STRING ) )
+		return OneShot<Hasher, Secure>( LUA );
 
-	CryptoPP::HMAC<Hasher> *hmac = new( std::nothrow ) CryptoPP::HMAC<Hasher>( );
+	WarnInsecure<Hasher, Secure>( LUA );
+
+	typedef cryptography::PrecomputedHMAC<Hasher> HMAC;
+	HMAC *hmac = new( std::nothrow ) HMAC( );
 	if( hmac == nullptr )
 	{
 		LUA->PushNil( );
@@ -304,18 +599,137 @@ static int Creator( lua_State *state )
 		return 2;
 	}
 
-	CryptoPP::SecByteBlock key( hmac->GetValidKeyLength( 16 ) );
-	CryptoPP::AutoSeededRandomPool( ).GenerateBlock( key.data( ), key.size( ) );
-	hmac->SetKey( key.data( ), key.size( ) );
+	if( LUA->IsType( 1, GarrysMod::Lua::Type::STRING ) )
+	{
+		uint32_t keylen = 0;
+		const uint8_t *key = reinterpret_cast<const uint8_t *>( LUA->GetString( 1, &keylen ) );
+		hmac->SetKey( key, keylen );
+	}
+	else
+	{
+		CryptoPP::SecByteBlock key( hmac->GetValidKeyLength( 16 ) );
+		CryptoPP::AutoSeededRandomPool( ).GenerateBlock( key.data( ), key.size( ) );
+		hmac->SetKey( key.data( ), key.size( ) );
+	}
 
-	LUA->PushUserType( hmac, metatype );
+	Push( LUA, hmac );
+	return 1;
+}
 
-	LUA->PushMetaTable( metatype );
-	LUA->SetMetaTable( -2 );
+// Whether MAC takes a nonce, asked once per type of a default instance.
+template<typename MAC>
+inline bool TakesNonce( )
+{
+	static const bool resynchronizable = MAC( ).IsResynchronizable( );
+	return resynchronizable;
+}
 
-	LUA->CreateTable( );
-	LUA->SetFEnv( -2 );
+// crypt.hmac.X( key, data ), or crypt.hmac.X( key, data, iv ) for the MACs that take a nonce,
+// keys a fresh MAC for every call since most of these are cheap to key or need a new nonce anyway
+template<typename MAC>
+static int CipherOneShot( GarrysMod::Lua::ILuaBase *LUA )
+{
+	uint32_t keylen = 0, len = 0;
+	const uint8_t *key = reinterpret_cast<const uint8_t *>( LUA->GetString( 1, &keylen ) );
+	const uint8_t *data = reinterpret_cast<const uint8_t *>( LUA->GetString( 2, &len ) );
+
+	try
+	{
+		MAC mac;
+		if( TakesNonce<MAC>( ) )
+		{
+			uint32_t ivlen = 0;
+			const uint8_t *iv = reinterpret_cast<const uint8_t *>( LUA->GetString( 3, &ivlen ) );
+			mac.SetKeyWithIV( key, keylen, iv, ivlen );
+		}
+		else
+		{
+			mac.SetKey( key, keylen );
+		}
+
+		// BLAKE2b has the longest tag of these MACs
+		uint8_t digest[CryptoPP::BLAKE2b::DIGESTSIZE];
+		mac.CalculateDigest( digest, data, len );
+
+		LUA->PushString( reinterpret_cast<const char *>( digest ), mac.DigestSize( ) );
+		return 1;
+	}
+	catch( const CryptoPP::Exception &e )
+	{
+		LUA->PushNil( );
+		LUA->PushString( e.what( ) );
+	}
+
+	return 2;
+}
+
+// crypt.hmac.X( [key[, iv]] ) for the block cipher based MACs and the natively keyed hashes,
+// a random key and, when the MAC needs one, a random nonce are used for whatever isn't given.
+// crypt.hmac.X( key, data ) is the one-shot tag, crypt.hmac.X( key, data, iv ) for the MACs
+// that take a nonce since their second argument is already the IV.
+template<typename MAC>
+static int CipherCreator( lua_State *state )
+{
+	GarrysMod::Lua::ILuaBase *LUA = state->luabase;
+	LUA->SetState( state );
+
+	if( LUA->IsType( 1, GarrysMod::Lua::Type::STRING ) && LUA->IsType( 2, GarrysMod::Lua::Type::STRING ) &&
+		( !TakesNonce<MAC>( ) || LUA->IsType( 3, GarrysMod::Lua::Type::STRING ) ) )
+		return CipherOneShot<MAC>( LUA );
+
+	MAC *mac = new( std::nothrow ) MAC( );
+	if( mac == nullptr )
+	{
+		LUA->PushNil( );
+		LUA->PushString( "failed to create MAC object" );
+		return 2;
+	}
+
+	try
+	{
+		CryptoPP::AutoSeededRandomPool prng;
+		CryptoPP::SecByteBlock key( mac->DefaultKeyLength( ) );
+		if( LUA->IsType( 1, GarrysMod::Lua::Type::STRING ) )
+		{
+			uint32_t keylen = 0;
+			const uint8_t *data = reinterpret_cast<const uint8_t *>( LUA->GetString( 1, &keylen ) );
+			key.Assign( data, keylen );
+		}
+		else
+		{
+			prng.GenerateBlock( key.data( ), key.size( ) );
+		}
+
+		if( mac->IsResynchronizable( ) )
+		{
+			CryptoPP::SecByteBlock iv( mac->IVSize( ) );
+			if( LUA->IsType( 2, GarrysMod::Lua::Type::STRING ) )
+			{
+				uint32_t ivlen = 0;
+				const uint8_t *data = reinterpret_cast<const uint8_t *>( LUA->GetString( 2, &ivlen ) );
+				iv.Assign( data, ivlen );
+			}
+			else
+			{
+				mac->GetNextIV( prng, iv.data( ) );
+			}
+
+			mac->SetKeyWithIV( key.data( ), key.size( ), iv.data( ), iv.size( ) );
+		}
+		else
+		{
+			mac->SetKey( key.data( ), key.size( ) );
+		}
+	}
+	catch( const CryptoPP::Exception &e )
+	{
+		delete mac;
+		LUA->PushNil( );
+		LUA->PushString( e.what( ) );
+		return 2;
+	}
 
+	Push( LUA, mac );
 	return 1;
 }
 
@@ -356,6 +770,15 @@ void Initialize( GarrysMod::Lua::ILuaBase *LUA )
 	LUA->PushCFunction( CalculateDigest );
 	LUA->SetField( -2, "CalculateDigest" );
 
+	LUA->PushCFunction( Verify );
+	LUA->SetField( -2, "Verify" );
+
+	LUA->PushCFunction( DigestMany );
+	LUA->SetField( -2, "DigestMany" );
+
+	LUA->PushCFunction( VerifyMany );
+	LUA->SetField( -2, "VerifyMany" );
+
 	LUA->PushCFunction( AlgorithmName );
 	LUA->SetField( -2, "AlgorithmName" );
 
@@ -380,6 +803,15 @@ void Initialize( GarrysMod::Lua::ILuaBase *LUA )
 	LUA->PushCFunction( SetKey );
 	LUA->SetField( -2, "SetKey" );
 
+	LUA->PushCFunction( Clone );
+	LUA->SetField( -2, "Clone" );
+
+	LUA->PushCFunction( IVSize );
+	LUA->SetField( -2, "IVSize" );
+
+	LUA->PushCFunction( Resynchronize );
+	LUA->SetField( -2, "Resynchronize" );
+
 	LUA->Pop( 1 );
 
 	LUA->CreateTable( );
@@ -426,11 +858,32 @@ void Initialize( GarrysMod::Lua::ILuaBase *LUA )
 	LUA->PushCFunction( Creator<CryptoPP::RIPEMD320> );
 	LUA->SetField( -2, "RIPEMD320" );
 
+	// keyed BLAKE2 takes the key in its parameter block, a single pass instead of HMAC's two
+	LUA->PushCFunction( CipherCreator< cryptography::ClonableHash<CryptoPP::BLAKE2b> > );
+	LUA->SetField( -2, "BLAKE2b" );
+
+	LUA->PushCFunction( CipherCreator< cryptography::ClonableHash<CryptoPP::BLAKE2s> > );
+	LUA->SetField( -2, "BLAKE2s" );
+
+	LUA->PushCFunction( CipherCreator< CryptoPP::CMAC<CryptoPP::AES> > );
+	LUA->SetField( -2, "CMAC" );
+
+	LUA->PushCFunction( CipherCreator< cryptography::NonceMAC< CryptoPP::Poly1305<CryptoPP::AES> > > );
+	LUA->SetField( -2, "Poly1305" );
+
+	LUA->PushCFunction( CipherCreator< cryptography::NonceMAC< CryptoPP::VMAC<CryptoPP::AES> > > );
+	LUA->SetField( -2, "VMAC" );
+
+	LUA->PushCFunction( CipherCreator< cryptography::NonceMAC< CryptoPP::VMAC<CryptoPP::AES, 64> > > );
+	LUA->SetField( -2, "VMAC64" );
+
 	LUA->SetField( -2, table_name );
 }
 
 void Deinitialize( GarrysMod::Lua::ILuaBase *LUA )
 {
+	oneshot_states.clear( );
+
 	LUA->PushNil( );
 	LUA->SetField( GarrysMod::Lua::INDEX_REGISTRY, metaname );
 }
@@ -0,0 +1,286 @@
+#include <kdf.hpp>
+#include <hkdf.hpp>
+#include <GarrysMod/Lua/Interface.h>
+#include <cstdint>
+#include <vector>
+
+namespace kdf
+{
+
+static const char *metaname = "kdf";
+static int32_t metatype = GarrysMod::Lua::Type::NONE;
+static const char *invalid_error = "invalid kdf";
+
+inline void CheckType( GarrysMod::Lua::ILuaBase *LUA, int32_t index )
+{
+	if( !LUA->IsType( index, metatype ) )
+		LUA->TypeError( index, metaname );
+}
+
+static cryptography::HKDF *GetUserData( GarrysMod::Lua::ILuaBase *LUA, int32_t index )
+{
+	CheckType( LUA, index );
+	return LUA->GetUserType<cryptography::HKDF>( index, metatype );
+}
+
+static cryptography::HKDF *Get( GarrysMod::Lua::ILuaBase *LUA, int32_t index )
+{
+	cryptography::HKDF *kdf = GetUserData( LUA, index );
+	if( kdf == nullptr )
+		LUA->ArgError( index, invalid_error );
+
+	return kdf;
+}
+
+// an optional string argument (the salt) defaults to empty
+static cryptography::bytes GetOptionalBytes( GarrysMod::Lua::ILuaBase *LUA, int32_t index )
+{
+	if( LUA->IsType( index, GarrysMod::Lua::Type::NONE ) || LUA->IsType( index, GarrysMod::Lua::Type::NIL ) )
+		return cryptography::bytes( );
+
+	LUA->CheckType( index, GarrysMod::Lua::Type::STRING );
+
+	uint32_t len = 0;
+	const uint8_t *data = reinterpret_cast<const uint8_t *>( LUA->GetString( index, &len ) );
+	return cryptography::bytes( data, data + len );
+}
+
+LUA_FUNCTION_STATIC( tostring )
+{
+
+#if defined _WIN32
+
+	LUA->PushFormattedString( "%s: %p", metaname, Get( LUA, 1 ) );
+
+#elif defined __linux || defined __APPLE__
+
+	LUA->PushFormattedString( "%s: 0x%p", metaname, Get( LUA, 1 ) );
+
+#endif
+
+	return 1;
+}
+
+LUA_FUNCTION_STATIC( eq )
+{
+	LUA->PushBool( Get( LUA, 1 ) == Get( LUA, 2 ) );
+	return 1;
+}
+
+LUA_FUNCTION_STATIC( index )
+{
+	CheckType( LUA, 1 );
+
+	LUA->PushMetaTable( metatype );
+	LUA->Push( 2 );
+	LUA->RawGet( -2 );
+	if( !LUA->IsType( -1, GarrysMod::Lua::Type::NIL ) )
+		return 1;
+
+	LUA->Pop( 2 );
+
+	LUA->GetFEnv( 1 );
+	LUA->Push( 2 );
+	LUA->RawGet( -2 );
+	return 1;
+}
+
+LUA_FUNCTION_STATIC( newindex )
+{
+	CheckType( LUA, 1 );
+
+	LUA->GetFEnv( 1 );
+	LUA->Push( 2 );
+	LUA->Push( 3 );
+	LUA->RawSet( -3 );
+	return 0;
+}
+
+LUA_FUNCTION_STATIC( gc )
+{
+	cryptography::HKDF *kdf = GetUserData( LUA, 1 );
+	if( kdf == nullptr )
+		return 0;
+
+	try
+	{
+		delete kdf;
+		LUA->SetUserType( 1, nullptr );
+		return 0;
+	}
+	catch( const CryptoPP::Exception &e )
+	{
+		LUA->PushString( e.what( ) );
+	}
+
+	return 1;
+}
+
+LUA_FUNCTION_STATIC( IsValid )
+{
+	LUA->PushBool( GetUserData( LUA, 1 ) != nullptr );
+	return 1;
+}
+
+LUA_FUNCTION_STATIC( Derive )
+{
+	cryptography::HKDF *kdf = Get( LUA, 1 );
+	LUA->CheckType( 2, GarrysMod::Lua::Type::STRING );
+	const size_t size = static_cast<size_t>( LUA->CheckNumber( 3 ) );
+
+	uint32_t len = 0;
+	const uint8_t *info = reinterpret_cast<const uint8_t *>( LUA->GetString( 2, &len ) );
+
+	cryptography::bytes derived;
+	if( !kdf->Derive( cryptography::bytes( info, info + len ), size, derived ) )
+	{
+		LUA->PushNil( );
+		LUA->PushString( kdf->GetLastError( ).c_str( ) );
+		return 2;
+	}
+
+	LUA->PushString( reinterpret_cast<const char *>( derived.data( ) ), derived.size( ) );
+	return 1;
+}
+
+LUA_FUNCTION_STATIC( DeriveMany )
+{
+	cryptography::HKDF *kdf = Get( LUA, 1 );
+	LUA->CheckType( 2, GarrysMod::Lua::Type::TABLE );
+	const size_t size = static_cast<size_t>( LUA->CheckNumber( 3 ) );
+
+	std::vector<cryptography::bytes> infos( static_cast<size_t>( LUA->ObjLen( 2 ) ) );
+	for( size_t i = 0; i < infos.size( ); ++i )
+	{
+		LUA->PushNumber( static_cast<double>( i + 1 ) );
+		LUA->GetTable( 2 );
+		if( !LUA->IsType( -1, GarrysMod::Lua::Type::STRING ) )
+			LUA->ArgError( 2, "array must only contain strings" );
+
+		uint32_t len = 0;
+		const uint8_t *info = reinterpret_cast<const uint8_t *>( LUA->GetString( -1, &len ) );
+		infos[i].assign( info, info + len );
+		LUA->Pop( 1 );
+	}
+
+	std::vector<cryptography::bytes> derived;
+	if( !kdf->DeriveMany( infos, size, derived ) )
+	{
+		LUA->PushNil( );
+		LUA->PushString( kdf->GetLastError( ).c_str( ) );
+		return 2;
+	}
+
+	LUA->CreateTable( );
+	for( size_t i = 0; i < derived.size( ); ++i )
+	{
+		LUA->PushNumber( static_cast<double>( i + 1 ) );
+		LUA->PushString( reinterpret_cast<const char *>( derived[i].data( ) ), derived[i].size( ) );
+		LUA->SetTable( -3 );
+	}
+
+	return 1;
+}
+
+LUA_FUNCTION_STATIC( SetCacheSize )
+{
+	Get( LUA, 1 )->SetCacheSize( static_cast<size_t>( LUA->CheckNumber( 2 ) ) );
+	return 0;
+}
+
+LUA_FUNCTION_STATIC( GetCacheSize )
+{
+	LUA->PushNumber( static_cast<double>( Get( LUA, 1 )->GetCacheSize( ) ) );
+	return 1;
+}
+
+// crypt.HKDF( master[, salt[, cacheSize]] )
+LUA_FUNCTION_STATIC( Creator )
+{
+	LUA->CheckType( 1, GarrysMod::Lua::Type::STRING );
+
+	uint32_t len = 0;
+	const uint8_t *master = reinterpret_cast<const uint8_t *>( LUA->GetString( 1, &len ) );
+	const cryptography::bytes salt = GetOptionalBytes( LUA, 2 );
+	const size_t cacheSize = LUA->IsType( 3, GarrysMod::Lua::Type::NUMBER ) ?
+		static_cast<size_t>( LUA->GetNumber( 3 ) ) : 0;
+
+	cryptography::HKDF *kdf = new( std::nothrow ) cryptography::HKDF( );
+	if( kdf == nullptr )
+	{
+		LUA->PushNil( );
+		LUA->PushString( "failed to create object" );
+		return 2;
+	}
+
+	if( !kdf->SetKey( cryptography::bytes( master, master + len ), salt ) )
+	{
+		LUA->PushNil( );
+		LUA->PushString( kdf->GetLastError( ).c_str( ) );
+		delete kdf;
+		return 2;
+	}
+
+	kdf->SetCacheSize( cacheSize );
+
+	LUA->PushUserType( kdf, metatype );
+
+	LUA->PushMetaTable( metatype );
+	LUA->SetMetaTable( -2 );
+
+	LUA->CreateTable( );
+	LUA->SetFEnv( -2 );
+
+	return 1;
+}
+
+void Initialize( GarrysMod::Lua::ILuaBase *LUA )
+{
+	metatype = LUA->CreateMetaTable( metaname );
+
+	LUA->PushCFunction( tostring );
+	LUA->SetField( -2, "__tostring" );
+
+	LUA->PushCFunction( eq );
+	LUA->SetField( -2, "__eq" );
+
+	LUA->PushCFunction( index );
+	LUA->SetField( -2, "__index" );
+
+	LUA->PushCFunction( newindex );
+	LUA->SetField( -2, "__newindex" );
+
+	LUA->PushCFunction( gc );
+	LUA->SetField( -2, "__gc" );
+
+	LUA->PushCFunction( gc );
+	LUA->SetField( -2, "Destroy" );
+
+	LUA->PushCFunction( IsValid );
+	LUA->SetField( -2, "IsValid" );
+
+	LUA->PushCFunction( Derive );
+	LUA->SetField( -2, "Derive" );
+
+	LUA->PushCFunction( DeriveMany );
+	LUA->SetField( -2, "DeriveMany" );
+
+	LUA->PushCFunction( SetCacheSize );
+	LUA->SetField( -2, "SetCacheSize" );
+
+	LUA->PushCFunction( GetCacheSize );
+	LUA->SetField( -2, "GetCacheSize" );
+
+	LUA->Pop( 1 );
+
+	LUA->PushCFunction( Creator );
+	LUA->SetField( -2, "HKDF" );
+}
+
+void Deinitialize( GarrysMod::Lua::ILuaBase *LUA )
+{
+	LUA->PushNil( );
+	LUA->SetField( GarrysMod::Lua::INDEX_REGISTRY, metaname );
+}
+
+}
@@ -2,7 +2,11 @@
 #include <crypt.hpp>
 #include <hash.hpp>
 #include <hmac.hpp>
+#include <agreement.hpp>
+#include <kdf.hpp>
+#include <password.hpp>
 #include <cryptopp/osrng.h>
+#include <cryptopp/misc.h>
 
 static const char *tablename = "crypt";
 
@@ -14,6 +18,19 @@ LUA_FUNCTION_STATIC( GenerateRandomBytes )
 	return 1;
 }
 
+// strings of different lengths are unequal right away, only the contents are compared in constant time
+LUA_FUNCTION_STATIC( ConstantTimeEquals )
+{
+	LUA->CheckType( 1, GarrysMod::Lua::Type::STRING );
+	LUA->CheckType( 2, GarrysMod::Lua::Type::STRING );
+
+	uint32_t len1 = 0, len2 = 0;
+	const uint8_t *data1 = reinterpret_cast<const uint8_t *>( LUA->GetString( 1, &len1 ) );
+	const uint8_t *data2 = reinterpret_cast<const uint8_t *>( LUA->GetString( 2, &len2 ) );
+	LUA->PushBool( len1 == len2 && CryptoPP::VerifyBufsEqual( data1, data2, len1 ) );
+	return 1;
+}
+
 GMOD_MODULE_OPEN( )
 {
 	LUA->CreateTable( );
@@ -28,9 +45,15 @@ GMOD_MODULE_OPEN( )
 	LUA->PushCFunction( GenerateRandomBytes );
 	LUA->SetField( -2, "GenerateRandomBytes" );
 
+	LUA->PushCFunction( ConstantTimeEquals );
+	LUA->SetField( -2, "ConstantTimeEquals" );
+
 	crypt::Initialize( LUA );
 	hash::Initialize( LUA );
 	hmac::Initialize( LUA );
+	agreement::Initialize( LUA );
+	kdf::Initialize( LUA );
+	password::Initialize( LUA );
 
 	LUA->SetField( GarrysMod::Lua::INDEX_GLOBAL, tablename );
 	return 0;
@@ -41,6 +64,9 @@ GMOD_MODULE_CLOSE( )
 	LUA->PushNil( );
 	LUA->SetField( GarrysMod::Lua::INDEX_GLOBAL, tablename );
 
+	password::Deinitialize( LUA );
+	kdf::Deinitialize( LUA );
+	agreement::Deinitialize( LUA );
 	hmac::Deinitialize( LUA );
 	hash::Deinitialize( LUA );
 	crypt::Deinitialize( LUA );
@@ -0,0 +1,297 @@
+#include <password.hpp>
+#include <passwordhash.hpp>
+#include <GarrysMod/Lua/Interface.h>
+#include <GarrysMod/Lua/LuaInterface.h>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <memory>
+#include <functional>
+
+namespace password
+{
+
+// a finished job, push places the callback's arguments on the stack and returns their count
+struct Completion
+{
+	int32_t callback;
+	std::function<int32_t( GarrysMod::Lua::ILuaBase *LUA )> push;
+};
+
+static const char *hook_name = "gm_crypt.password";
+static bool hooked = false;
+
+// workers can't touch Lua, finished jobs wait here until the next Think
+static std::mutex completed_mutex;
+static std::deque<Completion> completed;
+
+static cryptography::bytes GetBytes( GarrysMod::Lua::ILuaBase *LUA, int32_t index )
+{
+	LUA->CheckType( index, GarrysMod::Lua::Type::STRING );
+
+	uint32_t len = 0;
+	const uint8_t *data = reinterpret_cast<const uint8_t *>( LUA->GetString( index, &len ) );
+	return cryptography::bytes( data, data + len );
+}
+
+static double GetOptionalNumber( GarrysMod::Lua::ILuaBase *LUA, int32_t index, double def )
+{
+	if( LUA->IsType( index, GarrysMod::Lua::Type::NONE ) || LUA->IsType( index, GarrysMod::Lua::Type::NIL ) )
+		return def;
+
+	return LUA->CheckNumber( index );
+}
+
+LUA_FUNCTION_STATIC( Think )
+{
+	std::deque<Completion> ready;
+
+	{
+		std::lock_guard<std::mutex> lock( completed_mutex );
+		ready.swap( completed );
+	}
+
+	for( Completion &completion : ready )
+	{
+		LUA->ReferencePush( completion.callback );
+		LUA->ReferenceFree( completion.callback );
+
+		if( LUA->PCall( completion.push( LUA ), 0, 0 ) != 0 )
+		{
+			static_cast<GarrysMod::Lua::ILuaInterface *>( LUA )->ErrorNoHalt( "[gm_crypt] %s\n", LUA->GetString( -1 ) );
+			LUA->Pop( 1 );
+		}
+	}
+
+	return 0;
+}
+
+// Installs the Think hook that runs callbacks the first time an async operation is started.
+static void Hook( GarrysMod::Lua::ILuaBase *LUA )
+{
+	if( hooked )
+		return;
+
+	LUA->GetField( GarrysMod::Lua::INDEX_GLOBAL, "hook" );
+	if( !LUA->IsType( -1, GarrysMod::Lua::Type::TABLE ) )
+		LUA->ThrowError( "hook library is not available to run callbacks" );
+
+	LUA->GetField( -1, "Add" );
+	LUA->PushString( "Think" );
+	LUA->PushString( hook_name );
+	LUA->PushCFunction( Think );
+	LUA->Call( 3, 0 );
+	LUA->Pop( 1 );
+
+	hooked = true;
+}
+
+// Takes a reference to the callback at index, installing the Think hook if needed.
+static int32_t Reference( GarrysMod::Lua::ILuaBase *LUA, int32_t index )
+{
+	Hook( LUA );
+
+	LUA->Push( index );
+	return LUA->ReferenceCreate( );
+}
+
+static void Complete( int32_t callback, std::function<int32_t( GarrysMod::Lua::ILuaBase *LUA )> push )
+{
+	std::lock_guard<std::mutex> lock( completed_mutex );
+	completed.push_back( Completion { callback, std::move( push ) } );
+}
+
+// Returns a completion for the callback at index that Think calls with ( derived, nil ) or
+// ( nil, error ).
+static cryptography::PasswordHashCallback Defer( GarrysMod::Lua::ILuaBase *LUA, int32_t index )
+{
+	const int32_t callback = Reference( LUA, index );
+	return [callback]( cryptography::bytes &derived, const std::string &error )
+	{
+		std::shared_ptr<cryptography::bytes> result = std::make_shared<cryptography::bytes>( );
+		result->swap( derived );
+		Complete( callback, [result, error]( GarrysMod::Lua::ILuaBase *LUA )
+		{
+			if( error.empty( ) )
+			{
+				LUA->PushString( reinterpret_cast<const char *>( result->data( ) ), result->size( ) );
+				LUA->PushNil( );
+			}
+			else
+			{
+				LUA->PushNil( );
+				LUA->PushString( error.c_str( ) );
+			}
+
+			return 2;
+		} );
+	};
+}
+
+// crypt.Scrypt( password, salt, cost, blockSize, parallelization, size[, callback] )
+LUA_FUNCTION_STATIC( Scrypt )
+{
+	const cryptography::bytes password = GetBytes( LUA, 1 );
+	const cryptography::bytes salt = GetBytes( LUA, 2 );
+	const cryptography::ScryptParameters params = {
+		static_cast<uint64_t>( LUA->CheckNumber( 3 ) ),
+		static_cast<uint32_t>( LUA->CheckNumber( 4 ) ),
+		static_cast<uint32_t>( LUA->CheckNumber( 5 ) )
+	};
+	const size_t size = static_cast<size_t>( LUA->CheckNumber( 6 ) );
+
+	if( LUA->IsType( 7, GarrysMod::Lua::Type::FUNCTION ) )
+	{
+		cryptography::ScryptAsync( password, salt, params, size, Defer( LUA, 7 ) );
+		return 0;
+	}
+
+	cryptography::bytes derived;
+	std::string error;
+	if( !cryptography::Scrypt( password, salt, params, size, derived, error ) )
+	{
+		LUA->PushNil( );
+		LUA->PushString( error.c_str( ) );
+		return 2;
+	}
+
+	LUA->PushString( reinterpret_cast<const char *>( derived.data( ) ), derived.size( ) );
+	return 1;
+}
+
+// crypt.PBKDF2( password, salt, iterations, size[, callback] )
+LUA_FUNCTION_STATIC( PBKDF2 )
+{
+	const cryptography::bytes password = GetBytes( LUA, 1 );
+	const cryptography::bytes salt = GetBytes( LUA, 2 );
+	const uint32_t iterations = static_cast<uint32_t>( LUA->CheckNumber( 3 ) );
+	const size_t size = static_cast<size_t>( LUA->CheckNumber( 4 ) );
+
+	if( LUA->IsType( 5, GarrysMod::Lua::Type::FUNCTION ) )
+	{
+		cryptography::PBKDF2Async( password, salt, iterations, size, Defer( LUA, 5 ) );
+		return 0;
+	}
+
+	cryptography::bytes derived;
+	std::string error;
+	if( !cryptography::PBKDF2( password, salt, iterations, size, derived, error ) )
+	{
+		LUA->PushNil( );
+		LUA->PushString( error.c_str( ) );
+		return 2;
+	}
+
+	LUA->PushString( reinterpret_cast<const char *>( derived.data( ) ), derived.size( ) );
+	return 1;
+}
+
+// crypt.CalibrateScrypt( seconds[, blockSize[, parallelization[, maxMemory[, callback]]]] ), the
+// default parallelization gives one lane to every core of this host. With a callback it measures
+// in the background and calls back with ( cost, blockSize, parallelization ).
+LUA_FUNCTION_STATIC( CalibrateScrypt )
+{
+	const double seconds = LUA->CheckNumber( 1 );
+	const uint32_t blockSize = static_cast<uint32_t>( GetOptionalNumber( LUA, 2, 8 ) );
+	const uint32_t parallelization = static_cast<uint32_t>( GetOptionalNumber(
+		LUA,
+		3,
+		static_cast<double>( cryptography::ThreadPool::Instance( ).Size( ) + 1 )
+	) );
+	const size_t maxMemory = static_cast<size_t>( GetOptionalNumber( LUA, 4, 256 * 1024 * 1024 ) );
+
+	if( blockSize == 0 || parallelization == 0 )
+		LUA->ArgError( blockSize == 0 ? 2 : 3, "must be positive" );
+
+	if( LUA->IsType( 5, GarrysMod::Lua::Type::FUNCTION ) )
+	{
+		const int32_t callback = Reference( LUA, 5 );
+		cryptography::CalibrateScryptAsync( seconds, blockSize, parallelization, maxMemory,
+			[callback]( const cryptography::ScryptParameters &params )
+			{
+				Complete( callback, [params]( GarrysMod::Lua::ILuaBase *LUA )
+				{
+					LUA->PushNumber( static_cast<double>( params.cost ) );
+					LUA->PushNumber( params.blockSize );
+					LUA->PushNumber( params.parallelization );
+					return 3;
+				} );
+			}
+		);
+		return 0;
+	}
+
+	const cryptography::ScryptParameters params =
+		cryptography::CalibrateScrypt( seconds, blockSize, parallelization, maxMemory );
+
+	LUA->PushNumber( static_cast<double>( params.cost ) );
+	LUA->PushNumber( params.blockSize );
+	LUA->PushNumber( params.parallelization );
+	return 3;
+}
+
+// crypt.CalibratePBKDF2( seconds[, callback] ), the callback gets the iterations
+LUA_FUNCTION_STATIC( CalibratePBKDF2 )
+{
+	const double seconds = LUA->CheckNumber( 1 );
+	if( LUA->IsType( 2, GarrysMod::Lua::Type::FUNCTION ) )
+	{
+		const int32_t callback = Reference( LUA, 2 );
+		cryptography::CalibratePBKDF2Async( seconds, [callback]( uint32_t iterations )
+		{
+			Complete( callback, [iterations]( GarrysMod::Lua::ILuaBase *LUA )
+			{
+				LUA->PushNumber( iterations );
+				return 1;
+			} );
+		} );
+		return 0;
+	}
+
+	LUA->PushNumber( cryptography::CalibratePBKDF2( seconds ) );
+	return 1;
+}
+
+void Initialize( GarrysMod::Lua::ILuaBase *LUA )
+{
+	LUA->PushCFunction( Scrypt );
+	LUA->SetField( -2, "Scrypt" );
+
+	LUA->PushCFunction( PBKDF2 );
+	LUA->SetField( -2, "PBKDF2" );
+
+	LUA->PushCFunction( CalibrateScrypt );
+	LUA->SetField( -2, "CalibrateScrypt" );
+
+	LUA->PushCFunction( CalibratePBKDF2 );
+	LUA->SetField( -2, "CalibratePBKDF2" );
+}
+
+void Deinitialize( GarrysMod::Lua::ILuaBase *LUA )
+{
+	// cancels queued and running jobs, none completes into the next Lua state
+	cryptography::ThreadPool::Background( ).Shutdown( );
+
+	if( !hooked )
+		return;
+
+	LUA->GetField( GarrysMod::Lua::INDEX_GLOBAL, "hook" );
+	if( LUA->IsType( -1, GarrysMod::Lua::Type::TABLE ) )
+	{
+		LUA->GetField( -1, "Remove" );
+		LUA->PushString( "Think" );
+		LUA->PushString( hook_name );
+		LUA->Call( 2, 0 );
+	}
+
+	LUA->Pop( 1 );
+	hooked = false;
+
+	std::lock_guard<std::mutex> lock( completed_mutex );
+	for( const Completion &completion : completed )
+		LUA->ReferenceFree( completion.callback );
+
+	completed.clear( );
+}
+
+}
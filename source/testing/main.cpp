@@ -1,6 +1,62 @@
 #include <cryptography.hpp>
+#include <montgomery.hpp>
+#include <envelope.hpp>
+#include <keyagreement.hpp>
+#include <hkdf.hpp>
+#include <passwordhash.hpp>
+#include <precomputedhmac.hpp>
+#include <batchdigest.hpp>
+#include <noncemac.hpp>
+#include <crc32.hpp>
+#include <treehash.hpp>
+#include <multihash.hpp>
+#include <clonablehash.hpp>
+#include <hashstate.hpp>
+#include <siphash.hpp>
+#include <cryptopp/oids.h>
+#include <cryptopp/hkdf.h>
+#include <cryptopp/scrypt.h>
+#include <cryptopp/pwdbased.h>
+#include <cryptopp/hmac.h>
+#include <cryptopp/poly1305.h>
+#include <cryptopp/crc.h>
+#include <cryptopp/md5.h>
+#include <cryptopp/blake2.h>
+#include <cryptopp/sha3.h>
 #include <stdexcept>
 #include <iostream>
+#include <future>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+// RFC 6962 Merkle Tree Hash, computed recursively for comparison with TreeHash
+static void MerkleTreeHash( const uint8_t *data, size_t chunks, size_t length, size_t chunkSize, uint8_t *digest )
+{
+	CryptoPP::SHA256 sha256;
+	if( chunks == 1 )
+	{
+		const uint8_t prefix = 0;
+		sha256.Update( &prefix, 1 );
+		sha256.Update( data, length );
+		sha256.Final( digest );
+		return;
+	}
+
+	size_t split = 1;
+	while( split * 2 < chunks )
+		split *= 2;
+
+	uint8_t left[32], right[32];
+	MerkleTreeHash( data, split, split * chunkSize, chunkSize, left );
+	MerkleTreeHash( data + split * chunkSize, chunks - split, length - split * chunkSize, chunkSize, right );
+
+	const uint8_t prefix = 1;
+	sha256.Update( &prefix, 1 );
+	sha256.Update( left, sizeof( left ) );
+	sha256.Update( right, sizeof( right ) );
+	sha256.Final( digest );
+}
 
 int main( int argc, char *argv[] )
 {
@@ -27,6 +83,87 @@ int main( int argc, char *argv[] )
 	if( secondary.empty( ) )
 		throw std::runtime_error( ecp.GetLastError( ) );
 
+	if( !ecp.SetPrimaryKey( primary ) || !ecp.SetSecondaryKey( secondary ) || !ecp.Precompute( ) )
+		throw std::runtime_error( ecp.GetLastError( ) );
+
+	cryptography::bytes encrypted, decrypted;
+	if( !ecp.Encrypt( primary, encrypted ) || !ecp.Decrypt( encrypted, decrypted ) )
+		throw std::runtime_error( ecp.GetLastError( ) );
+
+	if( decrypted != primary )
+		throw std::runtime_error( "ECP round trip with precomputed public key failed" );
+
+	if( !ecp.SetEphemeralPoolSize( 4 ) )
+		throw std::runtime_error( ecp.GetLastError( ) );
+
+	for( int i = 0; i < 16; ++i )
+		if( !ecp.Encrypt( primary, encrypted ) || !ecp.Decrypt( encrypted, decrypted ) || decrypted != primary )
+			throw std::runtime_error( "ECP round trip with pooled ephemeral keys failed" );
+
+	{
+		cryptography::EphemeralPool &pool = cryptography::EphemeralPool::Instance( );
+		cryptography::Ephemeral ephemeral;
+		auto refill = [&pool, &ephemeral]( )
+		{
+			for( int i = 0; i < 500; ++i )
+			{
+				std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+				if( pool.Acquire( CryptoPP::ASN1::secp256r1( ), ephemeral ) )
+					return true;
+			}
+
+			return false;
+		};
+
+		// the misses above marked the curve in demand
+		if( !refill( ) )
+			throw std::runtime_error( "ephemeral pool did not refill on demand" );
+
+		{
+			// a second crypter on the curve keeps the queue alive when the first one drops out
+			cryptography::ECP other;
+			if( !other.SetPrimaryKey( primary ) || !other.SetSecondaryKey( secondary ) ||
+				!other.SetEphemeralPoolSize( 2 ) || !ecp.SetEphemeralPoolSize( 0 ) )
+				throw std::runtime_error( "failed to share the ephemeral pool" );
+
+			if( !refill( ) )
+				throw std::runtime_error( "ephemeral pool dropped a queue another crypter still uses" );
+		}
+
+		if( pool.Acquire( CryptoPP::ASN1::secp256r1( ), ephemeral ) )
+			throw std::runtime_error( "ephemeral pool kept a queue after its last crypter went away" );
+	}
+
+	cryptography::EphemeralPool::Instance( ).Shutdown( );
+
+	{
+		std::vector<cryptography::bytes> batch( 8, encrypted ), results;
+		std::vector<std::string> errors;
+		batch[5].back( ) ^= 1;
+		ecp.DecryptMany( batch, results, errors );
+		for( size_t i = 0; i < batch.size( ); ++i )
+			if( ( i == 5 ) == errors[i].empty( ) || ( i != 5 && results[i] != primary ) )
+				throw std::runtime_error( "ECP batch decryption failed" );
+	}
+
+	{
+		cryptography::bytes tampered( encrypted );
+		tampered[64] ^= 1;
+		if( ecp.Decrypt( tampered, decrypted ) )
+			throw std::runtime_error( "ECP decryption accepted an invalid ephemeral point" );
+	}
+
+	CryptoPP::AutoSeededRandomPool prng;
+	CryptoPP::DL_GroupParameters_EC<CryptoPP::ECP> p256( CryptoPP::ASN1::secp256r1( ) );
+	for( int i = 0; i < 16; ++i )
+	{
+		CryptoPP::Integer scalar( prng, CryptoPP::Integer::One( ), p256.GetMaxExponent( ) );
+		CryptoPP::ECP::Point point = p256.ExponentiateBase( scalar );
+		if( !( cryptography::p256::MultiplyBase( scalar ) == point ) ||
+			!( cryptography::p256::Multiply( point, scalar ) == p256.ExponentiateElement( point, scalar ) ) )
+			throw std::runtime_error( "P-256 backend disagrees with the generic curve arithmetic" );
+	}
+
 	cryptography::RSA rsa;
 
 	primary = rsa.GeneratePrimaryKey( 2048 );
@@ -37,5 +174,469 @@ int main( int argc, char *argv[] )
 	if( secondary.empty( ) )
 		throw std::runtime_error( rsa.GetLastError( ) );
 
+	if( !rsa.SetPrimaryKey( primary ) || !rsa.SetSecondaryKey( secondary ) )
+		throw std::runtime_error( rsa.GetLastError( ) );
+
+	primary = aes.GeneratePrimaryKey( 256 );
+	if( !rsa.Encrypt( primary, encrypted ) || !rsa.Decrypt( encrypted, decrypted ) || decrypted != primary )
+		throw std::runtime_error( "RSA round trip failed" );
+
+	if( !rsa.SetLatencyMode( true ) || !rsa.Decrypt( encrypted, decrypted ) || decrypted != primary )
+		throw std::runtime_error( "RSA round trip in latency mode failed" );
+
+	std::vector<cryptography::bytes> batch( 8, encrypted ), results;
+	std::vector<std::string> errors;
+	batch[3].clear( );
+	rsa.DecryptMany( batch, results, errors );
+	for( size_t i = 0; i < batch.size( ); ++i )
+		if( ( i == 3 ) == errors[i].empty( ) || ( i != 3 && results[i] != primary ) )
+			throw std::runtime_error( "RSA batch decryption failed" );
+
+	{
+		cryptography::bytes body, opened;
+		std::vector<cryptography::bytes> headers;
+		std::vector<std::string> failures;
+		std::string error;
+		std::vector<cryptography::Crypter *> recipients = { &rsa, &ecp, &rsa };
+		if( !cryptography::Seal( primary, recipients, body, headers, failures, error ) )
+			throw std::runtime_error( error );
+
+		for( size_t i = 0; i < recipients.size( ); ++i )
+			if( !failures[i].empty( ) ||
+				!cryptography::Open( *recipients[i], headers[i], body, opened, error ) ||
+				opened != primary )
+				throw std::runtime_error( "envelope round trip failed" );
+
+		body.back( ) ^= 1;
+		if( cryptography::Open( rsa, headers[0], body, opened, error ) )
+			throw std::runtime_error( "tampered envelope was opened" );
+
+		recipients = { &aes, &ecp };
+		if( !cryptography::Seal( primary, recipients, body, headers, failures, error ) ||
+			failures[0].empty( ) || !headers[0].empty( ) || !failures[1].empty( ) )
+			throw std::runtime_error( "envelope accepted a symmetric recipient" );
+	}
+
+	{
+		cryptography::ECDH ecdhA, ecdhB;
+		cryptography::X25519 x25519A, x25519B;
+		cryptography::Agreement *pairs[][2] = { { &ecdhA, &ecdhB }, { &x25519A, &x25519B } };
+		const cryptography::bytes salt( 16, 's' ), info( 4, 'i' );
+		for( auto &pair : pairs )
+		{
+			cryptography::AES send[2], receive[2];
+			if( !pair[0]->GenerateKeyPair( ) || !pair[1]->GenerateKeyPair( ) ||
+				!pair[0]->Derive( pair[1]->GetPublicKey( ), salt, info, send[0], receive[0] ) ||
+				!pair[1]->Derive( pair[0]->GetPublicKey( ), salt, info, send[1], receive[1] ) )
+				throw std::runtime_error( pair[0]->AlgorithmName( ) + " agreement failed" );
+
+			// each direction decrypts on the other side and uses its own key stream
+			cryptography::bytes reply;
+			if( !send[0].Encrypt( primary, encrypted ) || !receive[1].Decrypt( encrypted, decrypted ) ||
+				decrypted != primary || !send[1].Encrypt( primary, reply ) ||
+				!receive[0].Decrypt( reply, decrypted ) || decrypted != primary || reply == encrypted )
+				throw std::runtime_error( pair[0]->AlgorithmName( ) + " directional crypters failed" );
+
+			cryptography::bytes invalid( pair[1]->GetPublicKey( ).size( ), 0 ), derived;
+			if( pair[0]->Derive( invalid, salt, info, 32, derived ) )
+				throw std::runtime_error( pair[0]->AlgorithmName( ) + " accepted an invalid public key" );
+
+			if( pair[0]->Derive( pair[1]->GetPublicKey( ), salt, info, static_cast<size_t>( -1 ), derived ) )
+				throw std::runtime_error( pair[0]->AlgorithmName( ) + " accepted an oversized derivation" );
+		}
+	}
+
+	{
+		cryptography::HKDF hkdf;
+		const cryptography::bytes salt( 16, 's' );
+		if( !hkdf.SetKey( primary, salt ) )
+			throw std::runtime_error( hkdf.GetLastError( ) );
+
+		hkdf.SetCacheSize( 2 );
+		std::vector<cryptography::bytes> infos = { { 'a' }, { 'b' }, { 'a' }, { 'c' }, { 'a' }, { 'b' } };
+		for( size_t size : { 32, 100, 32 } )
+		{
+			std::vector<cryptography::bytes> derived;
+			if( !hkdf.DeriveMany( infos, size, derived ) )
+				throw std::runtime_error( hkdf.GetLastError( ) );
+
+			for( size_t i = 0; i < infos.size( ); ++i )
+			{
+				cryptography::bytes expected( size );
+				CryptoPP::HKDF<CryptoPP::SHA256>( ).DeriveKey(
+					expected.data( ), size,
+					primary.data( ), primary.size( ),
+					salt.data( ), salt.size( ),
+					infos[i].data( ), infos[i].size( )
+				);
+				if( derived[i] != expected )
+					throw std::runtime_error( "HKDF output disagrees with Crypto++" );
+			}
+		}
+	}
+
+	{
+		const cryptography::bytes salt( 16, 's' );
+		const cryptography::ScryptParameters params = { 1024, 8, 4 };
+		cryptography::bytes expected( 64 ), derived;
+		std::string error;
+		CryptoPP::Scrypt( ).DeriveKey(
+			expected.data( ), expected.size( ),
+			primary.data( ), primary.size( ),
+			salt.data( ), salt.size( ),
+			params.cost, params.blockSize, params.parallelization
+		);
+		if( !cryptography::Scrypt( primary, salt, params, 64, derived, error ) || derived != expected )
+			throw std::runtime_error( "scrypt disagrees with Crypto++" );
+
+		std::promise<cryptography::bytes> promise;
+		cryptography::ScryptAsync( primary, salt, params, 64, [&promise]( cryptography::bytes &result, const std::string & )
+		{
+			promise.set_value( result );
+		} );
+		if( promise.get_future( ).get( ) != expected )
+			throw std::runtime_error( "async scrypt disagrees with Crypto++" );
+
+		// shutting down cancels a long job instead of waiting for it, and never calls it back
+		std::atomic<bool> called( false );
+		const cryptography::ScryptParameters slow = { uint64_t( 1 ) << 16, 8, 4 };
+		cryptography::ScryptAsync( primary, salt, slow, 64, [&called]( cryptography::bytes &, const std::string & )
+		{
+			called = true;
+		} );
+
+		std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now( );
+		cryptography::ThreadPool::Background( ).Shutdown( );
+		if( std::chrono::steady_clock::now( ) - start > std::chrono::seconds( 1 ) || called )
+			throw std::runtime_error( "shutdown waited for or completed a cancelled scrypt job" );
+	}
+
+	{
+		const cryptography::bytes salt( 16, 's' );
+		cryptography::bytes expected( 80 ), derived;
+		std::string error;
+		CryptoPP::PKCS5_PBKDF2_HMAC<CryptoPP::SHA256>( ).DeriveKey(
+			expected.data( ), expected.size( ), 0,
+			primary.data( ), primary.size( ),
+			salt.data( ), salt.size( ),
+			1000, 0
+		);
+		if( !cryptography::PBKDF2( primary, salt, 1000, expected.size( ), derived, error ) || derived != expected )
+			throw std::runtime_error( "PBKDF2 disagrees with Crypto++" );
+
+		std::promise<uint32_t> calibrated;
+		cryptography::CalibratePBKDF2Async( 0.01, [&calibrated]( uint32_t iterations )
+		{
+			calibrated.set_value( iterations );
+		} );
+		if( calibrated.get_future( ).get( ) == 0 )
+			throw std::runtime_error( "background PBKDF2 calibration returned no iterations" );
+
+		std::atomic<bool> called( false );
+		cryptography::PBKDF2Async( primary, salt, 0xFFFFFFFF, 32, [&called]( cryptography::bytes &, const std::string & )
+		{
+			called = true;
+		} );
+
+		std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now( );
+		cryptography::ThreadPool::Background( ).Shutdown( );
+		if( std::chrono::steady_clock::now( ) - start > std::chrono::seconds( 1 ) || called )
+			throw std::runtime_error( "shutdown waited for or completed a cancelled PBKDF2 job" );
+	}
+
+	{
+		for( size_t length : { 0, 16, 64, 65, 200 } )
+		{
+			const cryptography::bytes key( length, 'k' );
+			CryptoPP::HMAC<CryptoPP::SHA256> reference( key.data( ), key.size( ) );
+			cryptography::PrecomputedHMAC<CryptoPP::SHA256> hmac( key.data( ), key.size( ) );
+
+			uint8_t expected[CryptoPP::SHA256::DIGESTSIZE], digest[CryptoPP::SHA256::DIGESTSIZE];
+			reference.CalculateDigest( expected, primary.data( ), primary.size( ) );
+
+			hmac.Update( primary.data( ), 7 );
+			std::unique_ptr<CryptoPP::MessageAuthenticationCode> clone( hmac.Clone( ) );
+			clone->Update( primary.data( ) + 7, primary.size( ) - 7 );
+			clone->Final( digest );
+			if( !std::equal( digest, digest + sizeof( digest ), expected ) )
+				throw std::runtime_error( "cloned HMAC disagrees with Crypto++" );
+
+			hmac.Restart( );
+			hmac.CalculateDigest( digest, primary.data( ), primary.size( ) );
+			if( !std::equal( digest, digest + sizeof( digest ), expected ) )
+				throw std::runtime_error( "HMAC disagrees with Crypto++" );
+		}
+	}
+
+	{
+		const cryptography::bytes key( 32, 'k' );
+		cryptography::PrecomputedHMAC<CryptoPP::SHA256> hmac( key.data( ), key.size( ) );
+		std::vector<cryptography::bytes> messages;
+		for( size_t i = 0; i < 300; ++i )
+			messages.push_back( cryptography::bytes( i * 3, static_cast<uint8_t>( i ) ) );
+
+		std::vector<cryptography::bytes> serial, parallel;
+		cryptography::DigestMany( hmac, messages, serial, false );
+		cryptography::DigestMany( hmac, messages, parallel, true );
+		if( serial != parallel )
+			throw std::runtime_error( "parallel HMAC batch disagrees with the serial one" );
+
+		serial[5][0] ^= 1;
+		serial[9].pop_back( );
+		std::vector<uint8_t> valid;
+		cryptography::VerifyMany( hmac, messages, serial, valid, true );
+		for( size_t i = 0; i < valid.size( ); ++i )
+			if( ( valid[i] != 0 ) != ( i != 5 && i != 9 ) )
+				throw std::runtime_error( "HMAC batch verification failed" );
+	}
+
+	{
+		const cryptography::bytes key( 32, 'k' ), nonce( 16, 'n' );
+		CryptoPP::Poly1305<CryptoPP::AES> reference( key.data( ), key.size( ), nonce.data( ), nonce.size( ) );
+		cryptography::NonceMAC< CryptoPP::Poly1305<CryptoPP::AES> > poly1305;
+		poly1305.SetKeyWithIV( key.data( ), key.size( ), nonce.data( ), nonce.size( ) );
+
+		uint8_t expected[16], tag[16];
+		reference.CalculateDigest( expected, primary.data( ), primary.size( ) );
+		poly1305.CalculateDigest( tag, primary.data( ), primary.size( ) );
+		if( !std::equal( tag, tag + sizeof( tag ), expected ) )
+			throw std::runtime_error( "Poly1305 disagrees with Crypto++" );
+
+		bool reused = true;
+		try
+		{
+			poly1305.CalculateDigest( tag, primary.data( ), primary.size( ) );
+		}
+		catch( const CryptoPP::Exception & )
+		{
+			reused = false;
+		}
+
+		if( reused )
+			throw std::runtime_error( "Poly1305 produced two tags under one nonce" );
+
+		poly1305.Resynchronize( nonce.data( ), static_cast<int>( nonce.size( ) ) );
+		poly1305.CalculateDigest( tag, primary.data( ), primary.size( ) );
+		if( !std::equal( tag, tag + sizeof( tag ), expected ) )
+			throw std::runtime_error( "resynchronized Poly1305 disagrees with Crypto++" );
+	}
+
+	{
+		const uint8_t check[] = { '1', '2', '3', '4', '5', '6', '7', '8', '9' };
+		uint8_t value[4];
+		cryptography::CRC32( ).CalculateDigest( value, check, sizeof( check ) );
+		if( CryptoPP::GetWord<CryptoPP::word32>( false, CryptoPP::LITTLE_ENDIAN_ORDER, value ) != 0xCBF43926 )
+			throw std::runtime_error( "CRC32 check value is wrong" );
+
+		cryptography::bytes data( 1000 );
+		for( size_t i = 0; i < data.size( ); ++i )
+			data[i] = static_cast<uint8_t>( i * 131 + 7 );
+
+		// folded blocks, table tails and split updates must agree with the table implementation
+		for( size_t len = 0; len <= data.size( ); len += 37 )
+		{
+			uint8_t expected[4];
+			CryptoPP::CRC32( ).CalculateDigest( expected, data.data( ), len );
+
+			cryptography::CRC32 crc;
+			crc.Update( data.data( ), len / 3 );
+			crc.Update( data.data( ) + len / 3, len - len / 3 );
+			crc.Final( value );
+			if( !std::equal( value, value + sizeof( value ), expected ) )
+				throw std::runtime_error( "CRC32 disagrees with Crypto++" );
+		}
+	}
+
+	{
+		// reference vector from the SipHash paper: key 00..0f, message 00..0e
+		uint8_t key[16], message[15];
+		for( size_t i = 0; i < sizeof( key ); ++i )
+			key[i] = static_cast<uint8_t>( i );
+
+		for( size_t i = 0; i < sizeof( message ); ++i )
+			message[i] = static_cast<uint8_t>( i );
+
+		cryptography::SipHash siphash( key, sizeof( key ) );
+		const double expected = static_cast<double>( 0xa129ca6149be45e5ULL & ( ( 1ULL << 52 ) - 1 ) );
+		if( cryptography::SipHashNumber( siphash, message, sizeof( message ) ) != expected )
+			throw std::runtime_error( "SipHash-2-4 disagrees with the reference vector" );
+	}
+
+	{
+		const size_t chunkSize = cryptography::TreeHash::MinChunkSize;
+		cryptography::bytes data( 23 * chunkSize + 100 );
+		for( size_t i = 0; i < data.size( ); ++i )
+			data[i] = static_cast<uint8_t>( i * 7 + i / 251 );
+
+		uint8_t expected[32], digest[32];
+		CryptoPP::SHA256( ).CalculateDigest( expected, nullptr, 0 );
+		cryptography::TreeHash( chunkSize ).Final( digest );
+		if( !std::equal( digest, digest + sizeof( digest ), expected ) )
+			throw std::runtime_error( "empty tree hash is wrong" );
+
+		// exact chunk multiples, short tails and updates that straddle chunks and batches
+		const size_t lengths[] = { 1, chunkSize, chunkSize + 1, 4 * chunkSize, 7 * chunkSize - 3, data.size( ) };
+		for( size_t length : lengths )
+		{
+			MerkleTreeHash( data.data( ), ( length + chunkSize - 1 ) / chunkSize, length, chunkSize, expected );
+
+			cryptography::TreeHash tree( chunkSize );
+			tree.CalculateDigest( digest, data.data( ), length );
+			if( !std::equal( digest, digest + sizeof( digest ), expected ) )
+				throw std::runtime_error( "tree hash disagrees with RFC 6962" );
+
+			for( size_t offset = 0; offset < length; offset += 777 )
+				tree.Update( data.data( ) + offset, std::min<size_t>( 777, length - offset ) );
+
+			tree.Final( digest );
+			if( !std::equal( digest, digest + sizeof( digest ), expected ) )
+				throw std::runtime_error( "streamed tree hash disagrees with RFC 6962" );
+		}
+	}
+
+	{
+		cryptography::MultiHash multi;
+		multi.Add( new cryptography::CRC32( ) );
+		multi.Add( new CryptoPP::Weak::MD5( ) );
+		multi.Add( new CryptoPP::SHA1( ) );
+		multi.Add( new CryptoPP::SHA256( ) );
+
+		// one update per path, cache sliced and one worker per hash
+		cryptography::bytes data( 3 * 1024 * 1024 + 5 );
+		for( size_t i = 0; i < data.size( ); ++i )
+			data[i] = static_cast<uint8_t>( i ^ ( i >> 9 ) );
+
+		multi.Update( data.data( ), 100000 );
+		std::unique_ptr<cryptography::MultiHash> clone( multi.Clone( ) );
+		multi.Update( data.data( ) + 100000, data.size( ) - 100000 );
+		clone->Update( data.data( ) + 100000, data.size( ) - 100000 );
+
+		std::vector<cryptography::bytes> digests, cloned;
+		multi.Final( digests );
+		clone->Final( cloned );
+		if( digests.size( ) != 4 || digests != cloned )
+			throw std::runtime_error( "multi-hash clone disagrees with the original" );
+
+		cryptography::CRC32 crc32;
+		CryptoPP::Weak::MD5 md5;
+		CryptoPP::SHA1 sha1;
+		CryptoPP::SHA256 sha256;
+		CryptoPP::HashTransformation *singles[] = { &crc32, &md5, &sha1, &sha256 };
+		for( size_t i = 0; i < 4; ++i )
+		{
+			cryptography::bytes expected( singles[i]->DigestSize( ) );
+			singles[i]->CalculateDigest( expected.data( ), data.data( ), data.size( ) );
+			if( digests[i] != expected )
+				throw std::runtime_error( "multi-hash disagrees with " + singles[i]->AlgorithmName( ) );
+		}
+	}
+
+	{
+		// a prefix absorbed once, then forked per suffix
+		const cryptography::bytes prefix( 1000, 'p' ), suffix( 10, 's' );
+		cryptography::ClonableHash<CryptoPP::BLAKE2b> blake2b;
+		cryptography::ClonableHash<CryptoPP::SHA3_256> sha3;
+		CryptoPP::HashTransformation *hashes[] = { &blake2b, &sha3 };
+		for( CryptoPP::HashTransformation *hash : hashes )
+		{
+			cryptography::bytes expected( hash->DigestSize( ) ), forked( hash->DigestSize( ) );
+			hash->Update( prefix.data( ), prefix.size( ) );
+			hash->Update( suffix.data( ), suffix.size( ) );
+			hash->Final( expected.data( ) );
+
+			hash->Update( prefix.data( ), prefix.size( ) );
+			std::unique_ptr<CryptoPP::HashTransformation> fork( static_cast<CryptoPP::HashTransformation *>( hash->Clone( ) ) );
+			hash->Restart( );
+			fork->Update( suffix.data( ), suffix.size( ) );
+			fork->Final( forked.data( ) );
+			if( forked != expected )
+				throw std::runtime_error( hash->AlgorithmName( ) + " clone lost its state" );
+		}
+	}
+
+	{
+		cryptography::bytes data( 3000 );
+		for( size_t i = 0; i < data.size( ); ++i )
+			data[i] = static_cast<uint8_t>( i * 13 + ( i >> 8 ) );
+
+		cryptography::ResumableIteratedHash<CryptoPP::SHA1, 20> sha1;
+		cryptography::ResumableIteratedHash<CryptoPP::SHA224, 32> sha224;
+		cryptography::ResumableIteratedHash<CryptoPP::SHA256, 32> sha256;
+		cryptography::ResumableIteratedHash<CryptoPP::SHA384, 64> sha384;
+		cryptography::ResumableIteratedHash<CryptoPP::SHA512, 64> sha512;
+		cryptography::CRC32 crc32;
+		cryptography::CRC32C crc32c;
+		CryptoPP::SHA1 sha1Reference;
+		CryptoPP::SHA224 sha224Reference;
+		CryptoPP::SHA256 sha256Reference;
+		CryptoPP::SHA384 sha384Reference;
+		CryptoPP::SHA512 sha512Reference;
+		CryptoPP::CRC32 crc32Reference;
+		CryptoPP::CRC32C crc32cReference;
+		std::pair<CryptoPP::HashTransformation *, CryptoPP::HashTransformation *> pairs[] = {
+			{ &sha1, &sha1Reference },
+			{ &sha224, &sha224Reference },
+			{ &sha256, &sha256Reference },
+			{ &sha384, &sha384Reference },
+			{ &sha512, &sha512Reference },
+			{ &crc32, &crc32Reference },
+			{ &crc32c, &crc32cReference }
+		};
+
+		// padding edges of both block sizes, unaligned input and a state exported mid-block
+		for( const auto &pair : pairs )
+			for( size_t len = 0; len < data.size( ); len += len < 300 ? 1 : 271 )
+			{
+				cryptography::bytes expected( pair.second->DigestSize( ) ), digest( expected.size( ) );
+				pair.second->CalculateDigest( expected.data( ), data.data( ) + 1, len );
+				pair.first->CalculateDigest( digest.data( ), data.data( ) + 1, len );
+				if( digest != expected )
+					throw std::runtime_error( pair.first->AlgorithmName( ) + " disagrees with Crypto++" );
+
+				cryptography::bytes state;
+				pair.first->Update( data.data( ) + 1, len / 2 );
+				dynamic_cast<cryptography::ResumableHash *>( pair.first )->ExportState( state );
+				pair.first->Restart( );
+				if( cryptography::HashStateAlgorithm( state ) != pair.first->AlgorithmName( ) )
+					throw std::runtime_error( pair.first->AlgorithmName( ) + " state has the wrong name" );
+
+				dynamic_cast<cryptography::ResumableHash *>( pair.first )->ImportState( state );
+				pair.first->Update( data.data( ) + 1 + len / 2, len - len / 2 );
+				pair.first->Final( digest.data( ) );
+				if( digest != expected )
+					throw std::runtime_error( pair.first->AlgorithmName( ) + " lost data across its exported state" );
+			}
+
+		cryptography::bytes state;
+		sha256.ExportState( state );
+		bool imported = true;
+		try
+		{
+			sha512.ImportState( state );
+		}
+		catch( const CryptoPP::Exception & )
+		{
+			imported = false;
+		}
+
+		if( imported )
+			throw std::runtime_error( "SHA-512 imported a SHA-256 state" );
+	}
+
+	cryptography::ThreadPool::Instance( ).Shutdown( );
+
+	// the RSA path only hands non power of two limb counts to the kernel (1536, 2560 and 3072), 1216
+	// and 1600 leave a partial 4-limb block for the tail loop
+	const unsigned int montgomeryBits[] = { 64, 128, 256, 512, 1024, 1216, 1536, 1600, 2048, 2560, 3072 };
+	for( unsigned int bits : montgomeryBits )
+	{
+		CryptoPP::Integer modulus( prng, bits - 1 ), base( prng, bits + 8 ), exponent( prng, bits );
+		modulus = 2 * modulus + 1;
+		if( cryptography::Montgomery( modulus ).Exponentiate( base, exponent ) != a_exp_b_mod_c( base, exponent, modulus ) )
+			throw std::runtime_error( "Montgomery exponentiation disagrees with Integer" );
+	}
+
 	return 0;
 }